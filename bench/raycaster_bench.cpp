@@ -0,0 +1,435 @@
+/*
+ * Headless raycaster micro-benchmark: no window, no GL context.
+ * -------------------------------------------------------------
+ * Drives Raycaster through deterministic camera trajectories over the built-in 24x24
+ * level, synthetic maps of arbitrary size and level files, and reports ns/ray, cells
+ * visited per ray, frame-time percentiles and heap allocations per frame.
+ *
+ *   raycaster_bench [--frames N] [--width W] [--height H] [--sizes 256,1024,4096]
+ *                   [--max-depth D] [--mode dda,field,pyramid,march,packet] [--threads 1,4,...]
+ *                   [--level file.lvl] [--views K] [--json [path]]
+ *
+ * "packet" runs the SIMD packet kernel once per instruction set the CPU supports
+ * (pk-scalar, pk-sse2, pk-avx2) so the per-ray speedup can be read off directly.
+ * With K > 1 each map also renders K cameras at mixed resolutions per frame, once as K
+ * single-view jobs (path "sepK") and once as one castViews() batch ("batchK").
+ */
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "map.h"
+#include "player.h"
+#include "raycaster.h"
+
+// --- Allocation counting: every global operator new in the process is tallied ---
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"  // GCC pairs inlined new-expressions with free()
+#endif
+static std::atomic<long long> gAllocations{0};
+
+void* operator new(std::size_t size) {
+    gAllocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+void* operator new[](std::size_t size) { return operator new(size); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { operator delete(p); }
+void operator delete(void* p, std::size_t) noexcept { operator delete(p); }
+void operator delete[](void* p, std::size_t) noexcept { operator delete(p); }
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+
+// Synthetic level: square rooms separated by walls with random doorways, plus scattered pillars.
+struct Rng {
+    unsigned state;
+    unsigned next() { state ^= state << 13; state ^= state >> 17; state ^= state << 5; return state; }
+};
+
+TileMap makeSyntheticMap(int size, int roomSize, unsigned seed) {
+    TileMap m(size, size);
+    Rng rng{seed};
+    for (int y = 0; y < size; ++y)
+        for (int x = 0; x < size; ++x) {
+            bool border = x == 0 || y == 0 || x == size - 1 || y == size - 1;
+            bool roomWall = (x % roomSize == 0) || (y % roomSize == 0);
+            bool pillar = (rng.next() % 100) < 3;
+            if (border || roomWall || pillar) m.setCell(x, y, Cell::Wall);
+        }
+    // Two-cell doorways in every room wall segment so the camera can roam.
+    for (int ry = 0; ry < size; ry += roomSize)
+        for (int rx = 0; rx < size; rx += roomSize) {
+            int dx = rx + 1 + static_cast<int>(rng.next() % (roomSize - 2));
+            int dy = ry + 1 + static_cast<int>(rng.next() % (roomSize - 2));
+            for (int k = 0; k < 2; ++k) {
+                if (ry > 0 && dx + k < size - 1) m.setCell(dx + k, ry, Cell::Empty);
+                if (rx > 0 && dy + k < size - 1) m.setCell(rx, dy + k, Cell::Empty);
+            }
+        }
+    return m;
+}
+
+// --- Deterministic camera trajectories ---
+enum class Path { Spin, Bounce };
+const char* pathName(Path p) { return p == Path::Spin ? "spin" : "bounce"; }
+
+template <class Grid>
+Player findOpenCenter(const Grid& grid, int width, int height) {
+    Player p;
+    for (int r = 0; r < std::max(width, height); ++r)
+        for (int y = height / 2 - r; y <= height / 2 + r; ++y)
+            for (int x = width / 2 - r; x <= width / 2 + r; ++x)
+                if (!grid(x, y)) { p.x = x + 0.5; p.y = y + 0.5; return p; }
+    return p;
+}
+
+// Precompute poses so trajectory generation is outside the timed region.
+template <class Grid>
+std::vector<Player> makeTrajectory(Path path, const Grid& grid, int width, int height, int frames) {
+    std::vector<Player> poses;
+    poses.reserve(frames);
+    Player p = findOpenCenter(grid, width, height);
+    double vx = 0.11, vy = 0.07;  // cells per frame
+    for (int i = 0; i < frames; ++i) {
+        double t = static_cast<double>(i) / frames;
+        if (path == Path::Spin) {
+            p.angle = 2.0 * kPi * t;
+        } else {
+            // Walk in a straight line, reflecting off blocking cells; look along heading with sway.
+            if (grid(static_cast<int>(p.x + vx), static_cast<int>(p.y))) vx = -vx;
+            if (grid(static_cast<int>(p.x), static_cast<int>(p.y + vy))) vy = -vy;
+            if (!grid(static_cast<int>(p.x + vx), static_cast<int>(p.y + vy))) { p.x += vx; p.y += vy; }
+            p.angle = std::atan2(vy, vx) + 0.4 * std::sin(4.0 * kPi * t);
+        }
+        poses.push_back(p);
+    }
+    return poses;
+}
+
+struct Result {
+    std::string map;
+    int size = 0;
+    std::string mode;
+    std::string path;
+    int threads = 1;
+    int frames = 0;
+    long long rays = 0;
+    double nsPerRay = 0.0;
+    double cellsPerRay = 0.0;
+    double p50 = 0.0, p90 = 0.0, p99 = 0.0, maxMs = 0.0;
+    double allocsPerFrame = 0.0;
+};
+
+double percentile(std::vector<double> v, double q) {
+    if (v.empty()) return 0.0;
+    std::sort(v.begin(), v.end());
+    size_t i = static_cast<size_t>(q * (v.size() - 1) + 0.5);
+    return v[std::min(i, v.size() - 1)];
+}
+
+// frameFn(pose) renders one frame and returns the number of cells visited.
+template <class FrameFn>
+Result runFrames(const std::vector<Player>& poses, int width, FrameFn&& frameFn) {
+    using Clock = std::chrono::steady_clock;
+    Result r;
+    std::vector<double> frameMs;
+    frameMs.reserve(poses.size());
+    frameFn(poses.front());  // warm-up
+
+    long long cells = 0;
+    long long allocsBefore = gAllocations.load();
+    auto total0 = Clock::now();
+    for (const Player& pose : poses) {
+        auto t0 = Clock::now();
+        cells += frameFn(pose);
+        frameMs.push_back(std::chrono::duration<double, std::milli>(Clock::now() - t0).count());
+    }
+    double totalNs = std::chrono::duration<double, std::nano>(Clock::now() - total0).count();
+    long long allocs = gAllocations.load() - allocsBefore;
+
+    r.frames = static_cast<int>(poses.size());
+    r.rays = static_cast<long long>(poses.size()) * width;
+    r.nsPerRay = totalNs / r.rays;
+    r.cellsPerRay = static_cast<double>(cells) / r.rays;
+    r.p50 = percentile(frameMs, 0.50);
+    r.p90 = percentile(frameMs, 0.90);
+    r.p99 = percentile(frameMs, 0.99);
+    r.maxMs = *std::max_element(frameMs.begin(), frameMs.end());
+    r.allocsPerFrame = static_cast<double>(allocs) / r.frames;
+    return r;
+}
+
+// A traversal to benchmark: mode plus (for packets) the forced instruction set.
+struct Variant {
+    Raycaster::Mode mode;
+    SimdIsa isa;
+    std::string name;
+};
+
+std::vector<Variant> makeVariants(const std::string& list) {
+    std::vector<Variant> variants;
+    auto wanted = [&](const char* name) { return list.find(name) != std::string::npos; };
+    if (wanted("dda")) variants.push_back({Raycaster::Mode::Dda, SimdIsa::Scalar, "dda"});
+    if (wanted("field")) variants.push_back({Raycaster::Mode::Field, SimdIsa::Scalar, "field"});
+    if (wanted("pyramid")) variants.push_back({Raycaster::Mode::Pyramid, SimdIsa::Scalar, "pyramid"});
+    if (wanted("march")) variants.push_back({Raycaster::Mode::FixedStep, SimdIsa::Scalar, "march"});
+    if (wanted("packet"))
+        for (SimdIsa isa : {SimdIsa::Scalar, SimdIsa::Sse2, SimdIsa::Avx2})
+            if (isa <= detectSimdIsa())
+                variants.push_back({Raycaster::Mode::Packet, isa, std::string("pk-") + simdIsaName(isa)});
+    return variants;
+}
+
+bool wanted(const std::vector<Variant>& variants, Raycaster::Mode mode) {
+    for (const Variant& v : variants)
+        if (v.mode == mode) return true;
+    return false;
+}
+
+void printTable(const std::vector<Result>& results) {
+    std::printf("%-10s %6s %-9s %-7s %4s %10s %10s %9s %9s %9s %9s %8s\n",
+                "map", "size", "mode", "path", "thr", "ns/ray", "cells/ray", "p50 ms", "p90 ms", "p99 ms", "max ms",
+                "alloc/f");
+    for (const Result& r : results)
+        std::printf("%-10s %6d %-9s %-7s %4d %10.2f %10.2f %9.3f %9.3f %9.3f %9.3f %8.2f\n",
+                    r.map.c_str(), r.size, r.mode.c_str(), r.path.c_str(), r.threads, r.nsPerRay, r.cellsPerRay,
+                    r.p50, r.p90, r.p99, r.maxMs, r.allocsPerFrame);
+}
+
+void writeJson(FILE* out, const std::vector<Result>& results, int width, int height, float maxDepth) {
+    std::fprintf(out, "{\n  \"width\": %d,\n  \"height\": %d,\n  \"max_depth\": %.2f,\n  \"results\": [\n",
+                 width, height, maxDepth);
+    for (size_t i = 0; i < results.size(); ++i) {
+        const Result& r = results[i];
+        std::fprintf(out,
+            "    {\"map\": \"%s\", \"size\": %d, \"mode\": \"%s\", \"path\": \"%s\", \"threads\": %d, \"frames\": %d, "
+            "\"rays\": %lld, \"ns_per_ray\": %.3f, \"cells_per_ray\": %.3f, "
+            "\"frame_ms\": {\"p50\": %.4f, \"p90\": %.4f, \"p99\": %.4f, \"max\": %.4f}, "
+            "\"allocs_per_frame\": %.3f}%s\n",
+            r.map.c_str(), r.size, r.mode.c_str(), r.path.c_str(), r.threads, r.frames, r.rays, r.nsPerRay,
+            r.cellsPerRay, r.p50, r.p90, r.p99, r.maxMs, r.allocsPerFrame, i + 1 < results.size() ? "," : "");
+    }
+    std::fprintf(out, "  ]\n}\n");
+}
+
+std::vector<int> parseList(const char* s) {
+    std::vector<int> sizes;
+    while (*s) {
+        sizes.push_back(std::atoi(s));
+        const char* comma = std::strchr(s, ',');
+        if (!comma) break;
+        s = comma + 1;
+    }
+    return sizes;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int frames = 240;
+    int width = 1280;
+    int height = 720;
+    float maxDepth = 16.0f;
+    std::vector<int> sizes = {256, 1024, 4096};
+    std::vector<Variant> variants = makeVariants("dda,field,pyramid,march,packet");
+    std::vector<int> threadCounts = {1};
+    int hw = static_cast<int>(std::thread::hardware_concurrency());
+    if (hw > 1) threadCounts.push_back(hw);
+    int viewCount = 4;
+    bool json = false;
+    const char* jsonPath = nullptr;
+    const char* levelPath = nullptr;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc && argv[i + 1][0] != '-';
+        if (arg == "--frames" && hasValue) frames = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--width" && hasValue) width = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--height" && hasValue) height = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--max-depth" && hasValue) maxDepth = static_cast<float>(std::atof(argv[++i]));
+        else if (arg == "--sizes" && hasValue) sizes = parseList(argv[++i]);
+        else if (arg == "--threads" && hasValue) threadCounts = parseList(argv[++i]);
+        else if (arg == "--mode" && hasValue) variants = makeVariants(argv[++i]);
+        else if (arg == "--level" && hasValue) levelPath = argv[++i];
+        else if (arg == "--views" && hasValue) viewCount = std::max(0, std::atoi(argv[++i]));
+        else if (arg == "--json") {
+            json = true;
+            if (hasValue) jsonPath = argv[++i];
+        } else {
+            std::fprintf(stderr,
+                "usage: %s [--frames N] [--width W] [--height H] [--sizes a,b,c] [--max-depth D]\n"
+                "          [--mode dda,field,pyramid,march,packet] [--threads a,b,c] [--level file.lvl] [--views K]\n"
+                "          [--json [path]]\n",
+                argv[0]);
+            return arg == "--help" ? 0 : 1;
+        }
+    }
+
+    Raycaster raycaster(width, height);
+    raycaster.setMaxDepth(maxDepth);
+    std::vector<Result> results;
+    const Path paths[] = {Path::Spin, Path::Bounce};
+
+    auto label = [&](Result r, const char* map, int size, const Variant& variant, Path path) {
+        r.map = map;
+        r.size = size;
+        r.mode = variant.name;
+        r.path = pathName(path);
+        r.threads = raycaster.threadCount();
+        results.push_back(r);
+    };
+
+    // Acceleration structures for the variants that use them, built outside the timed loops
+    // (distance fields on all hardware threads).
+    struct Accel {
+        DistanceField field;
+        OccupancyPyramid pyramid;
+    };
+    auto buildAccel = [&](Accel& accel, const TileMap& tiles, const char* name) {
+        if (wanted(variants, Raycaster::Mode::Field)) {
+            auto t0 = std::chrono::steady_clock::now();
+            accel.field.build(tiles, false, std::max(hw, 1));
+            double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+            std::fprintf(stderr, "%s %dx%d: distance field built in %.2f ms\n", name, tiles.width(), tiles.height(), ms);
+        }
+        if (wanted(variants, Raycaster::Mode::Pyramid)) {
+            auto t0 = std::chrono::steady_clock::now();
+            accel.pyramid.build(tiles);
+            double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+            std::fprintf(stderr, "%s %dx%d: occupancy pyramid built in %.2f ms\n", name, tiles.width(), tiles.height(), ms);
+        }
+    };
+
+    // Built-in level through the same entry point the game uses.
+    Map builtinMap;
+    builtinMap.buildDistanceField(std::max(hw, 1));
+    builtinMap.buildOccupancyPyramid();
+    const CellGrid builtin = builtinMap.tiles().grid(false);
+    RayHitBuffer hits(width);
+    for (int threads : threadCounts)
+        for (const Variant& variant : variants)
+            for (Path path : paths) {
+                raycaster.setThreadCount(threads);
+                raycaster.setMode(variant.mode);
+                raycaster.setSimdIsa(variant.isa);
+                auto poses = makeTrajectory(path, builtin, builtinMap.width(), builtinMap.height(), frames);
+                Result r = runFrames(poses, width, [&](const Player& pose) {
+                    return raycaster.castRays(pose, builtinMap, false, hits);
+                });
+                label(r, "builtin", builtinMap.width(), variant, path);
+            }
+
+    auto sweep = [&](const char* name, const CellGrid& grid, const Accel& accel) {
+        const PyramidGrid pyramid = accel.pyramid.grid(false);
+        for (int threads : threadCounts)
+            for (const Variant& variant : variants)
+                for (Path path : paths) {
+                    raycaster.setThreadCount(threads);
+                    raycaster.setMode(variant.mode);
+                    raycaster.setSimdIsa(variant.isa);
+                    auto poses = makeTrajectory(path, grid, grid.width, grid.height, frames);
+                    Result r = runFrames(poses, width, [&](const Player& pose) {
+                        return raycaster.castFrame(pose, grid, hits, &accel.field, &pyramid);
+                    });
+                    label(r, name, grid.width, variant, path);
+                }
+    };
+
+    // K cameras per frame: view k trails the trajectory by k/K of its length, looks a further
+    // k/K turn round and renders at 1, 1/2 or 1/4 of the screen size. "sep" casts them as K
+    // single-view jobs, "batch" as one castViews() job; both use the same kernels.
+    auto compareViews = [&](const char* name, const Map& map) {
+        if (viewCount < 2) return;
+        const CellGrid grid = map.tiles().grid(false);
+        const auto poses = makeTrajectory(Path::Bounce, grid, map.width(), map.height(), frames);
+        std::vector<Raycaster::View> views(viewCount);
+        for (int k = 0; k < viewCount; ++k) {
+            views[k].width = std::max(1, width >> (k % 3));
+            views[k].height = std::max(1, height >> (k % 3));
+        }
+        const int columns = Raycaster::layoutViews(views.data(), viewCount);
+        RayHitBuffer atlas(columns);
+        auto place = [&](const Player& pose) {
+            const size_t i = static_cast<size_t>(&pose - poses.data());
+            for (int k = 0; k < viewCount; ++k) {
+                views[k].pose = poses[(i + poses.size() - k * poses.size() / viewCount) % poses.size()];
+                views[k].pose.angle += 2.0 * kPi * k / viewCount;
+            }
+        };
+        const std::string sep = "sep" + std::to_string(viewCount), batch = "batch" + std::to_string(viewCount);
+        for (int threads : threadCounts)
+            for (const Variant& variant : variants) {
+                raycaster.setThreadCount(threads);
+                raycaster.setMode(variant.mode);
+                raycaster.setSimdIsa(variant.isa);
+                Result r = runFrames(poses, columns, [&](const Player& pose) {
+                    place(pose);
+                    long long cells = 0;
+                    for (int k = 0; k < viewCount; ++k) cells += raycaster.castViews(&views[k], 1, map, atlas);
+                    return cells;
+                });
+                label(r, name, map.width(), variant, Path::Bounce);
+                results.back().path = sep;
+                r = runFrames(poses, columns, [&](const Player& pose) {
+                    place(pose);
+                    return raycaster.castViews(views.data(), viewCount, map, atlas);
+                });
+                label(r, name, map.width(), variant, Path::Bounce);
+                results.back().path = batch;
+            }
+    };
+    compareViews("builtin", builtinMap);
+
+    // Synthetic sweep.
+    for (int size : sizes) {
+        if (size < 8) continue;
+        TileMap map = makeSyntheticMap(size, 16, 0x9E3779B9u ^ static_cast<unsigned>(size));
+        Accel accel;
+        buildAccel(accel, map, "synthetic");
+        sweep("synthetic", map.grid(false), accel);
+        if (viewCount < 2) continue;
+        Map viewMap(std::move(map), LevelInfo{});
+        if (wanted(variants, Raycaster::Mode::Field)) viewMap.buildDistanceField(std::max(hw, 1));
+        if (wanted(variants, Raycaster::Mode::Pyramid)) viewMap.buildOccupancyPyramid();
+        compareViews("synthetic", viewMap);
+    }
+
+    // Level file: opening it is an mmap, so the load time printed here excludes page faults.
+    if (levelPath) {
+        Map level;
+        auto t0 = std::chrono::steady_clock::now();
+        if (!level.load(levelPath)) return 1;
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+        std::fprintf(stderr, "%s: %dx%d opened in %.3f ms\n", levelPath, level.width(), level.height(), ms);
+        Accel accel;
+        buildAccel(accel, level.tiles(), levelPath);
+        sweep("level", level.tiles().grid(false), accel);
+        if (wanted(variants, Raycaster::Mode::Field)) level.buildDistanceField(std::max(hw, 1));
+        if (wanted(variants, Raycaster::Mode::Pyramid)) level.buildOccupancyPyramid();
+        compareViews("level", level);
+    }
+
+    if (json) {
+        FILE* out = jsonPath ? std::fopen(jsonPath, "w") : stdout;
+        if (!out) {
+            std::fprintf(stderr, "cannot write %s\n", jsonPath);
+            return 1;
+        }
+        writeJson(out, results, width, height, maxDepth);
+        if (out != stdout) std::fclose(out);
+        if (out == stdout) return 0;
+    }
+    printTable(results);
+    return 0;
+}
@@ -0,0 +1,224 @@
+/*
+ * Load client for session_server.
+ * -------------------------------
+ *   session_load [--socket PATH] [--clients C] [--sessions N] [--seconds S] [--hz 120]
+ *
+ * Opens C connections (one thread each), joins N sessions spread across them, then sends
+ * every session an input each tick, with buttons wandering as in `session_server --bench`,
+ * and reads the state stream. Reports states received per second against the expected
+ * rate, and input-to-state latency: from sending an input to receiving the first state
+ * that acknowledges it, which covers both socket hops and up to one server tick of wait.
+ */
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <errno.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "game_session.h"
+#include "session_protocol.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+namespace proto = SessionProtocol;
+
+constexpr uint32_t kSendRing = 4096;  // Send times kept per connection, by sequence number
+
+struct Rng {
+    unsigned state;
+    unsigned next() { state ^= state << 13; state ^= state >> 17; state ^= state << 5; return state; }
+};
+
+struct Result {
+    std::vector<double> latencyMs;
+    long long states = 0;
+    int joined = 0;
+    int rejected = 0;
+    bool failed = false;
+};
+
+bool sendAll(int fd, const std::vector<uint8_t>& bytes) {
+    size_t sent = 0;
+    while (sent < bytes.size()) {
+        const ssize_t n = send(fd, bytes.data() + sent, bytes.size() - sent, MSG_NOSIGNAL);
+        if (n > 0) sent += static_cast<size_t>(n);
+        else if (n < 0 && errno == EINTR) continue;
+        else return false;
+    }
+    return true;
+}
+
+template <class T> void append(std::vector<uint8_t>& out, const T& message) {
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&message);
+    out.insert(out.end(), bytes, bytes + sizeof message);
+}
+
+void runClient(const std::string& path, int sessions, double seconds, double hz, unsigned seed, Result& result) {
+    const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    std::strncpy(addr.sun_path, path.c_str(), sizeof addr.sun_path - 1);
+    if (fd < 0 || connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof addr) != 0) {
+        std::perror(path.c_str());
+        result.failed = true;
+        if (fd >= 0) close(fd);
+        return;
+    }
+
+    std::vector<uint8_t> out, in;
+    for (int i = 0; i < sessions; ++i) {
+        proto::JoinMsg m;
+        m.token = static_cast<uint32_t>(i);
+        append(out, m);
+    }
+    if (!sendAll(fd, out)) result.failed = true;
+
+    struct Session {
+        uint32_t id;
+        uint32_t lastAck = 0;
+        uint8_t buttons = 0;
+    };
+    std::vector<Session> owned;
+    std::unordered_map<uint32_t, size_t> byId;
+    std::vector<Clock::time_point> sentAt(kSendRing);
+    Rng rng{seed | 1u};
+    int replies = 0;
+
+    // Waits until `until` for data, then handles whatever has arrived. False if the server is gone.
+    auto receive = [&](Clock::time_point until) {
+        const auto wait = std::chrono::ceil<std::chrono::milliseconds>(until - Clock::now()).count();
+        pollfd p{fd, POLLIN, 0};
+        const int ready = poll(&p, 1, static_cast<int>(std::max<long long>(wait, 0)));
+        if (ready < 0 && errno != EINTR) return false;
+        if (ready > 0) {
+            uint8_t buffer[64 * 1024];
+            const ssize_t n = recv(fd, buffer, sizeof buffer, 0);
+            if (n <= 0) return false;
+            in.insert(in.end(), buffer, buffer + n);
+            const auto now = Clock::now();
+            size_t pos = 0;
+            while (pos < in.size()) {
+                const size_t size = proto::messageSize(in[pos]);
+                if (!size) return false;
+                if (in.size() - pos < size) break;
+                if (in[pos] == proto::Joined) {
+                    proto::JoinedMsg m;
+                    std::memcpy(&m, &in[pos], sizeof m);
+                    ++replies;
+                    if (m.session == proto::kNoSession) {
+                        ++result.rejected;
+                    } else {
+                        byId[m.session] = owned.size();
+                        owned.push_back(Session{m.session});
+                    }
+                } else if (in[pos] == proto::State) {
+                    proto::StateMsg m;
+                    std::memcpy(&m, &in[pos], sizeof m);
+                    ++result.states;
+                    const auto it = byId.find(m.session);
+                    if (it != byId.end() && m.ackSequence > owned[it->second].lastAck) {
+                        owned[it->second].lastAck = m.ackSequence;
+                        result.latencyMs.push_back(
+                            std::chrono::duration<double, std::milli>(now - sentAt[m.ackSequence % kSendRing]).count());
+                    }
+                }
+                pos += size;
+            }
+            in.erase(in.begin(), in.begin() + pos);
+        }
+        return true;
+    };
+
+    const auto joinDeadline = Clock::now() + std::chrono::seconds(10);
+    while (replies < sessions && Clock::now() < joinDeadline && !result.failed)
+        if (!receive(joinDeadline)) result.failed = true;
+    result.joined = static_cast<int>(owned.size());
+    result.states = 0;  // Count the timed run only
+
+    const auto period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / hz));
+    const auto end = Clock::now() + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
+    auto deadline = Clock::now();
+    for (uint32_t sequence = 1; Clock::now() < end && !result.failed; ++sequence) {
+        out.clear();
+        for (size_t i = 0; i < owned.size(); ++i) {
+            Session& s = owned[i];
+            if ((sequence + i) % 60 == 0) s.buttons = rng.next() & 15;
+            proto::InputMsg m;
+            m.session = s.id;
+            m.sequence = sequence;
+            m.buttons = s.buttons;
+            append(out, m);
+        }
+        sentAt[sequence % kSendRing] = Clock::now();
+        if (!sendAll(fd, out)) result.failed = true;
+        deadline += period;
+        while (Clock::now() < deadline && !result.failed)
+            if (!receive(deadline)) result.failed = true;
+    }
+    close(fd);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::string socketPath = proto::kDefaultSocket;
+    int clients = 4;
+    int sessions = 1000;
+    double seconds = 10.0;
+    double hz = 120.0;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc && argv[i + 1][0] != '-';
+        if (arg == "--socket" && hasValue) socketPath = argv[++i];
+        else if (arg == "--clients" && hasValue) clients = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--sessions" && hasValue) sessions = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--seconds" && hasValue) seconds = std::atof(argv[++i]);
+        else if (arg == "--hz" && hasValue) hz = std::max(1.0, std::atof(argv[++i]));
+        else {
+            std::fprintf(stderr, "usage: %s [--socket PATH] [--clients C] [--sessions N] [--seconds S] [--hz 120]\n",
+                         argv[0]);
+            return arg == "--help" ? 0 : 1;
+        }
+    }
+    clients = std::min(clients, sessions);
+
+    std::vector<Result> results(clients);
+    std::vector<std::thread> threads;
+    for (int c = 0; c < clients; ++c) {
+        const int share = sessions / clients + (c < sessions % clients ? 1 : 0);
+        threads.emplace_back(runClient, socketPath, share, seconds, hz, 0x9E3779B9u * (c + 1), std::ref(results[c]));
+    }
+    for (std::thread& t : threads) t.join();
+
+    std::vector<double> latency;
+    long long states = 0;
+    int joined = 0, rejected = 0, failed = 0;
+    for (const Result& r : results) {
+        latency.insert(latency.end(), r.latencyMs.begin(), r.latencyMs.end());
+        states += r.states;
+        joined += r.joined;
+        rejected += r.rejected;
+        failed += r.failed;
+    }
+    std::sort(latency.begin(), latency.end());
+    auto percentile = [&](double p) {
+        return latency.empty() ? 0.0 : latency[std::min(latency.size() - 1, static_cast<size_t>(p * latency.size()))];
+    };
+    std::printf("%d sessions joined (%d rejected) over %d clients (%d failed), %.0f s at %.0f Hz\n", joined, rejected,
+                clients, failed, seconds, hz);
+    std::printf("states: %.0f/s received, %.0f/s expected\n", states / seconds, joined * hz);
+    std::printf("input-to-state latency: p50 %.3f p99 %.3f max %.3f ms\n", percentile(0.5), percentile(0.99),
+                latency.empty() ? 0.0 : latency.back());
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,124 @@
+/*
+ * Headless VecEnv throughput benchmark.
+ * -------------------------------------
+ *   vec_env_bench [--level file.lvl] [--envs N] [--rays R] [--frame-height H] [--ticks T]
+ *                 [--threads 1,4,...] [--steps S]
+ *
+ * Steps N environments with random actions (each held for a few steps, like a wandering
+ * agent) and reports env-steps per second, episodes finished, mean reward and heap
+ * allocations per step, which should be zero.
+ */
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "map.h"
+#include "vec_env.h"
+
+// --- Allocation counting: every global operator new in the process is tallied ---
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"  // GCC pairs inlined new-expressions with free()
+#endif
+static std::atomic<long long> gAllocations{0};
+
+void* operator new(std::size_t size) {
+    gAllocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+void* operator new[](std::size_t size) { return operator new(size); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { operator delete(p); }
+void operator delete(void* p, std::size_t) noexcept { operator delete(p); }
+void operator delete[](void* p, std::size_t) noexcept { operator delete(p); }
+
+namespace {
+
+struct Rng {
+    unsigned state;
+    unsigned next() { state ^= state << 13; state ^= state >> 17; state ^= state << 5; return state; }
+};
+
+std::vector<int> parseList(const char* s) {
+    std::vector<int> values;
+    while (*s) {
+        values.push_back(std::max(1, std::atoi(s)));
+        const char* comma = std::strchr(s, ',');
+        if (!comma) break;
+        s = comma + 1;
+    }
+    return values;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    VecEnv::Config config;
+    config.count = 4096;
+    int steps = 2000;
+    std::vector<int> threadCounts = {1};
+    const int hw = static_cast<int>(std::thread::hardware_concurrency());
+    if (hw > 1) threadCounts.push_back(hw);
+    const char* levelPath = nullptr;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc && argv[i + 1][0] != '-';
+        if (arg == "--envs" && hasValue) config.count = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--rays" && hasValue) config.rays = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--frame-height" && hasValue) config.frameHeight = std::max(0, std::atoi(argv[++i]));
+        else if (arg == "--ticks" && hasValue) config.ticksPerStep = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--threads" && hasValue) threadCounts = parseList(argv[++i]);
+        else if (arg == "--steps" && hasValue) steps = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--level" && hasValue) levelPath = argv[++i];
+        else {
+            std::fprintf(stderr,
+                "usage: %s [--level file.lvl] [--envs N] [--rays R] [--frame-height H] [--ticks T]\n"
+                "          [--threads a,b,c] [--steps S]\n",
+                argv[0]);
+            return arg == "--help" ? 0 : 1;
+        }
+    }
+
+    Map map;
+    if (levelPath && !map.load(levelPath)) {
+        std::fprintf(stderr, "could not load %s\n", levelPath);
+        return 1;
+    }
+    std::printf("%s %dx%d: %d envs, %d rays, %d-row frame, %d ticks/step\n", levelPath ? levelPath : "built-in",
+                map.width(), map.height(), config.count, config.rays, config.frameHeight, config.ticksPerStep);
+
+    std::vector<uint8_t> actions(config.count);
+    for (int threads : threadCounts) {
+        config.threads = threads;
+        VecEnv env(map, config);
+        Rng rng{0x9E3779B9u};
+        long long episodes = 0;
+        double rewardSum = 0.0;
+        const long long allocationsBefore = gAllocations.load();
+        const auto t0 = std::chrono::steady_clock::now();
+        for (int s = 0; s < steps; ++s) {
+            for (int e = 0; e < config.count; ++e)
+                if ((s + e) % 8 == 0) actions[e] = static_cast<uint8_t>(rng.next() & 0x6F);
+            env.step(actions.data());
+            for (int e = 0; e < config.count; ++e) {
+                episodes += env.done()[e];
+                rewardSum += env.reward()[e];
+            }
+        }
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        const double envSteps = static_cast<double>(steps) * config.count;
+        std::printf("threads %2d: %.2f M env-steps/s (%.0f ns each), %lld episodes, mean reward %.4f, "
+                    "%.2f allocations/step\n",
+                    threads, envSteps / seconds / 1e6, seconds * 1e9 / envSteps, episodes, rewardSum / envSteps,
+                    static_cast<double>(gAllocations.load() - allocationsBefore) / steps);
+    }
+    return 0;
+}
@@ -0,0 +1,55 @@
+#ifndef DISTANCE_FIELD_H
+#define DISTANCE_FIELD_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "tile_map.h"
+
+/*
+ * Chebyshev (chessboard) distance from every cell to the nearest cell a ray could stop at,
+ * for one key state. A cell with value d has no such cell within the (2d - 1)-wide square
+ * centred on it, so a marcher can leave that square in one jump instead of walking it.
+ * "Could stop at" is anything non-empty except an unlocked door; outside the map counts as
+ * solid. Values are capped at kMaxDistance and stored row-major, one byte per cell, which is
+ * also the layout uploaded as the GL distance texture.
+ */
+class DistanceField {
+public:
+    static constexpr int kMaxDistance = 64;
+
+    struct Rect { int x0 = 0, y0 = 0, x1 = 0, y1 = 0; };  // [x0, x1) x [y0, y1)
+
+    // Full build; bands of rows are computed in parallel on `threads` threads.
+    void build(const TileMap& tiles, bool hasKey, int threads);
+    // Switch key state, recomputing only the neighbourhood of the map's doors.
+    void setKeyState(const TileMap& tiles, bool hasKey);
+
+    bool empty() const { return cells_.empty(); }
+    bool hasKey() const { return hasKey_; }
+    int width() const { return width_; }
+    int height() const { return height_; }
+    const uint8_t* data() const { return cells_.data(); }
+    int at(int x, int y) const {
+        if (static_cast<unsigned>(x) >= static_cast<unsigned>(width_) ||
+            static_cast<unsigned>(y) >= static_cast<unsigned>(height_)) return 0;
+        return cells_[static_cast<size_t>(y) * width_ + x];
+    }
+
+    // Bumped on every build / key change; changed() is the area rewritten by the last one.
+    unsigned revision() const { return revision_; }
+    const Rect& changed() const { return changed_; }
+
+private:
+    void computeRect(const TileMap& tiles, const Rect& r, std::vector<uint8_t>& scratch);
+
+    std::vector<uint8_t> cells_;
+    std::vector<Rect> doorBlocks_;  // Areas whose distances depend on door cells
+    int width_ = 0;
+    int height_ = 0;
+    bool hasKey_ = false;
+    unsigned revision_ = 0;
+    Rect changed_;
+};
+
+#endif // DISTANCE_FIELD_H
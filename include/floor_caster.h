@@ -0,0 +1,24 @@
+#ifndef FLOOR_CASTER_H
+#define FLOOR_CASTER_H
+
+#include "raycaster.h"
+
+class Framebuffer;
+class ThreadPool;
+class WallTextures;
+
+/*
+ * Floor and ceiling casting for the CPU renderer. Every floor row lies at one distance
+ * from the camera (the wall-projection formula inverted), so world coordinates step
+ * linearly across the row and one colormap serves the whole row; the ceiling row
+ * mirrored about the horizon shares both. Texture coordinates are stepped in 16.16 fixed
+ * point, 8 pixels at a time with AVX2 gathers where the CPU has it.
+ *
+ * Only pixels outside the wall span of their column (y < wallTop[x] or y > wallBottom[x])
+ * are written, so this pass and the column-parallel wall pass can run in either order
+ * without overdraw. Work is split into bands of rows on the pool.
+ */
+void castFloorAndCeiling(Framebuffer& fb, const Raycaster::Camera& cam, const WallTextures& textures,
+                         const int* wallTop, const int* wallBottom, SimdIsa isa, ThreadPool* pool);
+
+#endif // FLOOR_CASTER_H
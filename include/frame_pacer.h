@@ -0,0 +1,48 @@
+#ifndef FRAME_PACER_H
+#define FRAME_PACER_H
+
+#include <cstdint>
+#include <string>
+
+enum class FramePacing {
+    VSync,          // Wait for every vertical blank
+    AdaptiveVSync,  // Sync when on time, tear instead of stalling a whole refresh when late
+    Uncapped,       // Present immediately
+    Limited,        // Present immediately, then hold the frame to a fixed rate
+};
+
+bool parseFramePacing(const std::string& name, FramePacing& pacing);  // vsync, adaptive, uncapped, limit
+const char* framePacingName(FramePacing pacing);
+
+/*
+ * Measures frame time with SDL_GetPerformanceCounter and, in Limited mode, holds each frame
+ * to the target rate: it sleeps while more than kSpinMs remain, then spins on the counter,
+ * so the deadline is met to a few microseconds without burning a core for the whole frame.
+ * Deadlines advance by exactly one period, so an early or late frame does not shift the rest.
+ */
+class FramePacer {
+public:
+    void start(FramePacing pacing, double limitHz);
+
+    // Call once per frame after presenting. Waits if the mode asks for it, then returns the
+    // seconds since the previous call.
+    double endFrame();
+
+    FramePacing pacing() const { return pacing_; }
+    double frameMs() const;   // Mean over the last kHistory frames
+    double jitterMs() const;  // Standard deviation over the last kHistory frames
+
+private:
+    static constexpr int kHistory = 128;
+    static constexpr double kSpinMs = 2.0;
+
+    FramePacing pacing_ = FramePacing::VSync;
+    double frequency_ = 1.0;  // Counter ticks per second
+    uint64_t period_ = 0;     // Ticks per frame in Limited mode
+    uint64_t deadline_ = 0;
+    uint64_t last_ = 0;
+    float history_[kHistory] = {};
+    int count_ = 0;
+};
+
+#endif // FRAME_PACER_H
@@ -0,0 +1,58 @@
+#ifndef FRAMEBUFFER_H
+#define FRAMEBUFFER_H
+
+#include <cstdint>
+#include <memory>
+
+/*
+ * 32-bit ARGB8888 software framebuffer for the CPU renderer.
+ * Either owns 64-byte aligned storage, or is attached each frame to external memory
+ * (a locked SDL streaming texture) so the frame is rasterized straight into the upload
+ * buffer with no intermediate copy. All drawing calls clip to the buffer.
+ */
+class Framebuffer {
+public:
+    Framebuffer() = default;
+    Framebuffer(int width, int height) { allocate(width, height); }
+
+    void allocate(int width, int height);                               // Own aligned storage
+    void attach(uint32_t* pixels, int width, int height, int pitchBytes);  // Render into external memory
+
+    int width() const { return width_; }
+    int height() const { return height_; }
+    int pitch() const { return pitch_; }  // In pixels
+    uint32_t* row(int y) { return pixels_ + static_cast<ptrdiff_t>(y) * pitch_; }
+    const uint32_t* row(int y) const { return pixels_ + static_cast<ptrdiff_t>(y) * pitch_; }
+
+    static uint32_t rgb(uint8_t r, uint8_t g, uint8_t b) {
+        return 0xFF000000u | (static_cast<uint32_t>(r) << 16) | (static_cast<uint32_t>(g) << 8) | b;
+    }
+
+    void clear(uint32_t color);
+    void fillRect(int x, int y, int w, int h, uint32_t color);
+    void drawRect(int x, int y, int w, int h, uint32_t color);  // 1-pixel outline
+    void drawLine(int x0, int y0, int x1, int y1, uint32_t color);  // 1 pixel wide, end points included
+    // Copy an opaque image (e.g. a cached layer) to (x, y).
+    void copyImage(const uint32_t* src, int srcPitchPixels, int w, int h, int x, int y);
+    // Alpha-blend a premultiplied-free ARGB8888 image (e.g. a TTF surface) at (x, y).
+    void blendImage(const uint32_t* src, int srcPitchPixels, int w, int h, int x, int y);
+    // Scale an opaque w x h image to cover the whole buffer, nearest texel (texel centers map
+    // to pixel centers). Writes rows [rowBegin, rowEnd) only, so bands can go to a thread pool.
+    void stretchImage(const uint32_t* src, int srcPitchPixels, int w, int h, int rowBegin, int rowEnd);
+
+    // Rows top..bottom (inclusive, clipped) of column x from a palette-indexed texel column:
+    // the texel for a row is texels[(v >> 16) & texelMask], with v starting at v0 on row
+    // `top` and advancing by vStep (16.16 fixed point) per row, looked up in colormap.
+    void drawTexturedColumn(int x, int top, int bottom, const uint8_t* texels, uint32_t texelMask,
+                            uint32_t v0, uint32_t vStep, const uint32_t* colormap);
+
+private:
+    struct AlignedFree { void operator()(uint32_t* p) const; };
+    std::unique_ptr<uint32_t, AlignedFree> storage_;
+    uint32_t* pixels_ = nullptr;
+    int width_ = 0;
+    int height_ = 0;
+    int pitch_ = 0;
+};
+
+#endif // FRAMEBUFFER_H
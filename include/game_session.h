@@ -0,0 +1,59 @@
+#ifndef GAME_SESSION_H
+#define GAME_SESSION_H
+
+#include <cstdint>
+#include "player.h"
+
+class Map;
+
+// Buttons held during a tick. Movement is map-aligned, like WASD in the game.
+namespace Button { enum : uint8_t { North = 1, South = 2, West = 4, East = 8, Restart = 16, All = 31 }; }
+
+struct SessionInput {
+    uint8_t buttons = 0;  // Button bits
+    double angle = 0.0;   // View direction; kept with the player, does not steer movement
+};
+
+/*
+ * One player's game: position, key, timer and score, and the rules that change them.
+ * There is no window, renderer or clock: the owner calls tick() at a fixed rate with the
+ * buttons held, so the same rules run in the game and, thousands of sessions at a time,
+ * in the session server. The map is shared and only read; each session collides with the
+ * blocking bitplane of its own key state.
+ */
+class GameSession {
+public:
+    static constexpr double kTimeLimit = 120.0;  // Seconds to reach the exit
+    static constexpr double kMoveSpeed = 3.0;    // Cells per second along each held direction
+    static constexpr int kTicksPerSecond = 120;  // The game's fixed tick; replays are played at it
+
+    // What a tick changed, for owners that react to it (notifications, map caches).
+    enum Event : uint8_t { KeyPickedUp = 1, Escaped = 2, TimedOut = 4, Restarted = 8 };
+
+    explicit GameSession(const Map& map) : map_(&map) { reset(); }
+
+    void reset();  // Spawn point, full timer, no key
+    // Returns Event bits. Collision checks only the destination cell, so a step is capped
+    // at one cell: a tick longer than 1 / kMoveSpeed moves no further than one that long.
+    uint8_t tick(const SessionInput& input, double seconds);
+
+    const Player& player() const { return player_; }
+    bool hasKey() const { return hasKey_; }
+    bool hasWon() const { return hasWon_; }
+    bool hasLost() const { return hasLost_; }
+    double timeLeft() const { return timer_; }
+    double elapsed() const { return elapsed_; }  // Seconds played (the "time taken" on a win)
+    int score() const { return score_; }         // Seconds left when the exit was reached
+
+private:
+    const Map* map_;
+    Player player_;
+    double timer_ = kTimeLimit;
+    double elapsed_ = 0.0;
+    int score_ = 0;
+    bool hasKey_ = false;
+    bool hasWon_ = false;
+    bool hasLost_ = false;
+};
+
+#endif // GAME_SESSION_H
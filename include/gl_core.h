@@ -5,26 +5,42 @@
 #include <stddef.h>
 
 #define GL_VERTEX_SHADER   0x8B31
-#define GL_FRAGMENT_SHADER 0x8B20
+#define GL_FRAGMENT_SHADER 0x8B30
 #define GL_COMPILE_STATUS  0x8B81
 #define GL_LINK_STATUS     0x8B82
 #define GL_ARRAY_BUFFER    0x8892
 #define GL_STATIC_DRAW     0x88E4
 #define GL_TEXTURE_2D      0x0DE1
 #define GL_TEXTURE0        0x84C0
+#define GL_TEXTURE1        0x84C1
 #define GL_RED             0x1903
 #define GL_R8              0x8229
 #define GL_UNSIGNED_BYTE   0x1401
 #define GL_NEAREST         0x2600
+#define GL_LINEAR          0x2601
+#define GL_UNPACK_ALIGNMENT 0x0CF5
 #define GL_CLAMP_TO_EDGE   0x812F
 #define GL_TEXTURE_MIN_FILTER 0x2801
 #define GL_TEXTURE_MAG_FILTER 0x2800
 #define GL_TEXTURE_WRAP_S  0x2802
 #define GL_TEXTURE_WRAP_T  0x2803
 #define GL_TRIANGLES       0x0004
-#define GL_COLOR_BUFFER_BIT 0x0000
+#define GL_COLOR_BUFFER_BIT 0x4000
 #define GL_FLOAT           0x1406
 #define GL_FALSE           0
+#define GL_RGBA            0x1908
+#define GL_RGBA32F         0x8814
+#define GL_RGBA8           0x8058
+#define GL_FRAMEBUFFER     0x8D40
+#define GL_READ_FRAMEBUFFER 0x8CA8
+#define GL_DRAW_FRAMEBUFFER 0x8CA9
+#define GL_COLOR_ATTACHMENT0 0x8CE0
+#define GL_COLOR_ATTACHMENT1 0x8CE1
+#define GL_FRAMEBUFFER_COMPLETE 0x8CD5
+#define GL_MAX_TEXTURE_SIZE 0x0D33
+#define GL_TIME_ELAPSED    0x88BF
+#define GL_QUERY_RESULT    0x8866
+#define GL_QUERY_RESULT_AVAILABLE 0x8867
 
 typedef int GLsizei;
 typedef ptrdiff_t GLsizeiptr;
@@ -35,6 +51,7 @@ typedef unsigned char GLboolean;
 typedef float GLfloat;
 typedef ptrdiff_t GLintptr;
 typedef unsigned int GLbitfield;
+typedef unsigned long long GLuint64;
 
 int gl_core_load(void);
 
@@ -72,8 +89,24 @@ extern void (*glBindTexture)(GLenum, GLuint);
 extern void (*glActiveTexture)(GLenum);
 extern void (*glTexParameteri)(GLenum, GLenum, GLint);
 extern void (*glTexImage2D)(GLenum, GLint, GLint, GLsizei, GLsizei, GLint, GLenum, GLenum, const void*);
+extern void (*glTexSubImage2D)(GLenum, GLint, GLint, GLint, GLsizei, GLsizei, GLenum, GLenum, const void*);
+extern void (*glPixelStorei)(GLenum, GLint);
 extern void (*glClear)(GLbitfield);
 extern void (*glClearColor)(GLfloat, GLfloat, GLfloat, GLfloat);
 extern void (*glViewport)(GLint, GLint, GLsizei, GLsizei);
+extern void (*glGetIntegerv)(GLenum, GLint*);
+extern void (*glGenFramebuffers)(GLsizei, GLuint*);
+extern void (*glDeleteFramebuffers)(GLsizei, const GLuint*);
+extern void (*glBindFramebuffer)(GLenum, GLuint);
+extern void (*glFramebufferTexture2D)(GLenum, GLenum, GLenum, GLuint, GLint);
+extern GLenum (*glCheckFramebufferStatus)(GLenum);
+extern void (*glDrawBuffers)(GLsizei, const GLenum*);
+extern void (*glBlitFramebuffer)(GLint, GLint, GLint, GLint, GLint, GLint, GLint, GLint, GLbitfield, GLenum);
+extern void (*glGenQueries)(GLsizei, GLuint*);
+extern void (*glDeleteQueries)(GLsizei, const GLuint*);
+extern void (*glBeginQuery)(GLenum, GLuint);
+extern void (*glEndQuery)(GLenum);
+extern void (*glGetQueryObjectiv)(GLuint, GLenum, GLint*);
+extern void (*glGetQueryObjectui64v)(GLuint, GLenum, GLuint64*);
 
 #endif
@@ -1,23 +1,84 @@
 #ifndef MAP_H
 #define MAP_H
 
-#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include "distance_field.h"
+#include "occupancy_pyramid.h"
+#include "tile_map.h"
+
+class MappedFile;
 
 /*
- * Maze world: fixed 2D grid. Each cell is either empty or wall (or special: door, key, exit).
- * Used for collision detection and by the raycasting renderer.
+ * Level file (.lvl), version 1, little-endian. A fixed 128-byte header followed by the
+ * TileMap storage exactly as it sits in memory (cells, then both blocking bitplanes), so
+ * a level is used in place from the mapping with no parsing or conversion.
  */
-namespace Cell { enum { Empty = 0, Wall = 1, Door = 2, Key = 3, Exit = 4 }; }
+struct LevelFileHeader {
+    char magic[8];          // "RCLEVEL\0"
+    uint32_t version;       // kVersion
+    uint32_t headerBytes;   // sizeof(LevelFileHeader)
+    int32_t width;
+    int32_t height;
+    int32_t tileSize;       // TileMap::kTileSize
+    float spawnX, spawnY, spawnAngle;
+    int32_t keyX, keyY;     // -1 if the level has no key
+    int32_t exitX, exitY;   // -1 if the level has no exit
+    uint64_t tilesOffset;   // From the start of the file; 64-byte aligned
+    uint64_t tilesBytes;    // TileMap::storageBytes(width, height)
+    uint8_t reserved[56];
+
+    static constexpr uint32_t kVersion = 1;
+};
+static_assert(sizeof(LevelFileHeader) == 128, "level header layout is part of the file format");
+
+// Where the player starts and where the key and exit are (-1 if absent).
+struct LevelInfo {
+    float spawnX = 1.5f, spawnY = 1.5f, spawnAngle = 0.0f;
+    int keyX = -1, keyY = -1;
+    int exitX = -1, exitY = -1;
+};
 
+/*
+ * Maze world: 2D grid. Each cell is either empty or wall (or special: door, key, exit).
+ * Used for collision detection and by the raycasting renderer.
+ * A default-constructed Map is the built-in 24x24 dungeon; load() swaps in a level file.
+ */
 class Map {
 public:
-    static bool isBlocking(int x, int y, bool hasKey);  // Collision: true if player cannot walk through
-    static int getCell(int x, int y);
+    Map();                                  // Built-in dungeon
+    Map(TileMap tiles, const LevelInfo& info);
+    ~Map();
+    Map(Map&&) noexcept;
+    Map& operator=(Map&&) noexcept;
+
+    bool load(const std::string& path);        // mmap a level file; on failure the map is unchanged
+    bool save(const std::string& path) const;  // Write this map as a level file
+
+    bool isBlocking(int x, int y, bool hasKey) const { return tiles_.blocks(x, y, hasKey); }  // Collision
+    int getCell(int x, int y) const { return tiles_.cell(x, y); }
+    int width() const { return tiles_.width(); }
+    int height() const { return tiles_.height(); }
+
+    const TileMap& tiles() const { return tiles_; }  // Tiled cells + blocking bitplanes
+    const LevelInfo& info() const { return info_; }
 
-    static constexpr int width  = 24;
-    static constexpr int height = 24;
+    // Empty-space skipping for the marchers. Built on demand (it reads every cell, so a
+    // freshly mapped level stays lazy until then); setKeyHeld() updates it around doors.
+    void buildDistanceField(int threads);
+    void setKeyHeld(bool hasKey) { field_.setKeyState(tiles_, hasKey); }
+    const DistanceField& distanceField() const { return field_; }
+    // Hierarchical alternative for long rays on big maps; covers both key states.
+    void buildOccupancyPyramid() { pyramid_.build(tiles_); }
+    const OccupancyPyramid& occupancyPyramid() const { return pyramid_; }
 
-    static const std::array<std::array<int, width>, height> layout;  // Maze data structure
+private:
+    TileMap tiles_;
+    DistanceField field_;
+    OccupancyPyramid pyramid_;
+    LevelInfo info_;
+    std::unique_ptr<MappedFile> file_;  // Backing storage when loaded from disk
 };
 
 #endif // MAP_H
@@ -0,0 +1,34 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/*
+ * Read-only file opened as a private copy-on-write memory mapping (mmap / MapViewOfFile).
+ * Pages are faulted in on first touch, so opening a large file costs no I/O up front.
+ * Writes through data() stay in this process and never reach the file.
+ */
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile() { close(); }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const std::string& path);  // Prints the reason to std::cerr on failure
+    void close();
+
+    uint8_t* data() const { return data_; }
+    size_t size() const { return size_; }
+
+private:
+    uint8_t* data_ = nullptr;
+    size_t size_ = 0;
+#ifdef _WIN32
+    void* mapping_ = nullptr;  // HANDLE of the file mapping object
+#endif
+};
+
+#endif // MAPPED_FILE_H
@@ -0,0 +1,39 @@
+#ifndef MINIMAP_CACHE_H
+#define MINIMAP_CACHE_H
+
+#include "framebuffer.h"
+
+class Map;
+
+/*
+ * Static layer of the CPU minimap. Cells are drawn once, cellPixels square, into an owned
+ * framebuffer and copied to the screen each frame, so a frame costs one copy of the
+ * visible window however many cells it shows. Only a window of the map around the view
+ * is cached, kMarginCells wider than the view on each side: large maps cost the same as
+ * small ones, and scrolling rebuilds the layer only when the view leaves the window.
+ * The layer depends on whether the key is held (doors drawn open, key cells empty) and
+ * is rebuilt when that changes or after invalidate().
+ */
+class MinimapCache {
+public:
+    explicit MinimapCache(int cellPixels) : cellPixels_(cellPixels) {}
+
+    void invalidate() { valid_ = false; }  // The map was replaced
+
+    // Cells [x0, x0 + spanX) x [y0, y0 + spanY), top-left corner at (sx, sy).
+    void draw(Framebuffer& fb, const Map& map, bool hasKey, int x0, int y0, int spanX, int spanY, int sx, int sy);
+
+private:
+    static constexpr int kMarginCells = 8;
+
+    void rebuild(const Map& map, bool hasKey, int x0, int y0, int spanX, int spanY);
+
+    int cellPixels_;
+    Framebuffer layer_;
+    int originX_ = 0, originY_ = 0;  // First cached cell
+    int cellsX_ = 0, cellsY_ = 0;    // Cached cells per axis
+    bool hasKey_ = false;
+    bool valid_ = false;
+};
+
+#endif // MINIMAP_CACHE_H
@@ -0,0 +1,88 @@
+#ifndef NAVIGATION_H
+#define NAVIGATION_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "tile_map.h"
+
+class Map;
+
+/*
+ * Breadth-first flow field toward one target cell over the 4-connected cells passable for
+ * one key state. Neighbouring reachable cells differ in distance by at most one, so each
+ * cell only stores its distance mod 3 (3 = unreachable): that is enough to tell which
+ * neighbour is one step closer, making next() O(1) for any number of callers. The codes
+ * are two bitplanes per 8x8 tile, in TileMap's tile order, so a field costs 2 bits per
+ * cell (64 MB for a 16k x 16k map) and nothing per query; builds borrow one more bit per
+ * cell while they run. The search itself expands whole tiles at a time against TileMap's
+ * blocking bitplanes.
+ */
+class FlowField {
+public:
+    struct Step { int dx = 0, dy = 0; };  // (0, 0) at the target or where it is unreachable
+
+    // Full breadth-first build. A target outside the map or on a blocked cell leaves
+    // every cell unreachable.
+    void build(const TileMap& tiles, int targetX, int targetY, bool hasKey);
+    // Switch key state and rebuild for it. On the shipped levels the target is only
+    // reachable through the doors, so nearly the whole field changes either way.
+    void setKeyState(const TileMap& tiles, bool hasKey);
+
+    bool empty() const { return codes_.empty(); }
+    bool hasKey() const { return hasKey_; }
+    bool reachable(int x, int y) const { return code(x, y) != kUnreachable; }
+    // The neighbour one step closer to the target.
+    Step next(int x, int y) const;
+    // Steps to the target, found by walking the field (O(distance)); -1 if unreachable.
+    long long distance(int x, int y) const;
+
+    size_t bytes() const { return codes_.size() * sizeof(uint64_t); }
+
+private:
+    static constexpr int kUnreachable = 3;
+
+    int code(int x, int y) const {
+        if (static_cast<unsigned>(x) >= static_cast<unsigned>(width_) ||
+            static_cast<unsigned>(y) >= static_cast<unsigned>(height_)) return kUnreachable;
+        const size_t t = static_cast<size_t>(CellGrid::tile(x, y, tilesX_)) * 2;
+        const int b = CellGrid::bit(x, y);
+        return static_cast<int>(((codes_[t] >> b) & 1) | (((codes_[t + 1] >> b) & 1) << 1));
+    }
+    // Tiles with some cells set, for the word-parallel breadth-first passes.
+    struct TileBits {
+        int tile;
+        uint64_t bits;
+    };
+    void setCode(int x, int y, int code);
+    void setCodes(int tile, uint64_t cells, long long dist);
+    // ORs the 4-neighbours of the frontier cells into pending; tiles it makes non-zero go to touched.
+    void spread(const std::vector<TileBits>& frontier, std::vector<uint64_t>& pending,
+                std::vector<int>& touched) const;
+
+    std::vector<uint64_t> codes_;  // [tile][low bits, high bits]
+    int width_ = 0, height_ = 0, tilesX_ = 0;
+    int targetX_ = -1, targetY_ = -1;
+    bool hasKey_ = false;
+};
+
+/*
+ * Flow fields toward the level's key (walked without it) and exit (walked with the
+ * current key state), for the on-screen objective hint and for agents. setKeyHeld()
+ * rebuilds the exit field for the new key state.
+ */
+class Navigation {
+public:
+    void build(const Map& map, bool hasKey);
+    void setKeyHeld(const Map& map, bool hasKey);
+
+    const FlowField& toKey() const { return toKey_; }
+    const FlowField& toExit() const { return toExit_; }
+    // The field for the current objective: the key until it is held, then the exit.
+    const FlowField& objective(bool hasKey) const { return hasKey ? toExit_ : toKey_; }
+
+private:
+    FlowField toKey_, toExit_;
+};
+
+#endif // NAVIGATION_H
@@ -0,0 +1,53 @@
+#ifndef OCCUPANCY_PYRAMID_H
+#define OCCUPANCY_PYRAMID_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "tile_map.h"
+
+// Read-only view of an OccupancyPyramid for one key state. Level k covers aligned 2^k x 2^k
+// blocks and reports whether a block holds anything that stops a ray (or lies partly outside
+// the map, which reads as Wall). Levels 0-3 are answered from the TileMap bitplane word of
+// the block's 8x8 tile; levels 4 and up have one byte per block.
+struct PyramidGrid {
+    static constexpr int kTileLevels = 4;   // Levels 0..3 live inside one tile word
+    static constexpr int kMaxLevels = 32;
+
+    const uint8_t* nodes[kMaxLevels] = {};  // [k], k >= kTileLevels: row-major, nonzero = occupied
+    int nodesX[kMaxLevels] = {};
+    int levels = 0;                         // Levels 0..levels-1 are usable
+
+    bool occupied(const CellGrid& g, int k, int x, int y) const {
+        if (k >= kTileLevels) return nodes[k][static_cast<size_t>(y >> k) * nodesX[k] + (x >> k)] != 0;
+        uint64_t word = g.blocking[CellGrid::tile(x, y, g.tilesX)];
+        const int rx = g.width - (x & ~7), ry = g.height - (y & ~7);  // Edge tiles: pad counts as wall
+        if (rx < 8) word |= ((0xFFull << rx) & 0xFFull) * 0x0101010101010101ull;
+        if (ry < 8) word |= ~0ull << (ry * 8);
+        static constexpr uint64_t kBlock[kTileLevels] = {0x1ull, 0x0303ull, 0x0F0F0F0Full, ~0ull};
+        const int mask = ~((1 << k) - 1);
+        return (word & (kBlock[k] << CellGrid::bit(x & mask, y & mask))) != 0;
+    }
+};
+
+/*
+ * Min/max mip chain over the blocking bitplanes ("any blocking cell in this 2^k block"),
+ * for both key states. Lets a ray leave a whole empty block at once, so crossing an open
+ * hall costs O(log n) steps instead of one per cell. Built from the tile words only; for a
+ * 16k x 16k map the node levels take about 1.4 MB per key state.
+ */
+class OccupancyPyramid {
+public:
+    void build(const TileMap& tiles);
+
+    bool empty() const { return levels_ == 0; }
+    PyramidGrid grid(bool hasKey) const;
+
+private:
+    std::vector<uint8_t> nodes_[2];  // [hasKey]: levels kTileLevels.. back to back
+    std::vector<size_t> offsets_;    // [k]: start of level k in nodes_
+    std::vector<int> nodesX_;        // [k]
+    int levels_ = 0;
+};
+
+#endif // OCCUPANCY_PYRAMID_H
@@ -1,6 +1,8 @@
 #ifndef PLAYER_H
 #define PLAYER_H
 
+#include <cmath>
+
 class Player {
 public:
     double x = 1.5;
@@ -8,4 +10,15 @@ public:
     double angle = 0.0;
 };
 
+// Player state a fraction t of the way from a to b (t in [0, 1]); angles take the short way round.
+inline Player interpolate(const Player& a, const Player& b, double t) {
+    constexpr double kTwoPi = 6.283185307179586;
+    double turn = std::remainder(b.angle - a.angle, kTwoPi);
+    Player p;
+    p.x = a.x + (b.x - a.x) * t;
+    p.y = a.y + (b.y - a.y) * t;
+    p.angle = a.angle + turn * t;
+    return p;
+}
+
 #endif // PLAYER_H
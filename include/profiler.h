@@ -0,0 +1,85 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+/*
+ * Frame profiler: scoped zones and counters go into a fixed-size lock-free ring (the oldest
+ * events are overwritten), timed with the steady high-resolution clock. Recording costs two
+ * clock reads and one atomic increment per zone and never allocates. writeChromeTrace()
+ * dumps the ring as Chrome / Perfetto trace JSON (chrome://tracing, ui.perfetto.dev).
+ * Names must be string literals or otherwise outlive the profiler.
+ */
+class Profiler {
+public:
+    explicit Profiler(int capacity = 1 << 16);  // Rounded up to a power of two
+
+    Profiler(const Profiler&) = delete;
+    Profiler& operator=(const Profiler&) = delete;
+
+    void setEnabled(bool enabled) { enabled_.store(enabled, std::memory_order_relaxed); }
+    bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+    // Nanoseconds since the profiler was created.
+    int64_t now() const {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - origin_).count();
+    }
+
+    // Safe to call from any thread.
+    void zone(const char* name, int64_t startNs, int64_t endNs) { push(name, startNs, endNs - startNs, 'X'); }
+    void counter(const char* name, double value) { push(name, now(), static_cast<int64_t>(value * 1e3), 'C'); }
+
+    // Writes the events still in the ring, oldest first. Events being written by another
+    // thread at that moment are skipped. Prints the reason to std::cerr on failure.
+    bool writeChromeTrace(const std::string& path) const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Event {
+        const char* name;
+        int64_t startNs;
+        int64_t value;   // Zone: duration in ns; counter: value * 1000
+        uint32_t thread;
+        char phase;      // Chrome trace phase: 'X' complete zone, 'C' counter
+    };
+    // seq is 0 while the slot is being written, then (index + 1) of the event it holds.
+    struct Slot {
+        std::atomic<uint64_t> seq{0};
+        Event event{};
+    };
+
+    void push(const char* name, int64_t startNs, int64_t value, char phase);
+    static uint32_t threadIndex();
+
+    std::unique_ptr<Slot[]> slots_;
+    uint64_t mask_ = 0;
+    std::atomic<uint64_t> head_{0};
+    std::atomic<bool> enabled_{true};
+    Clock::time_point origin_ = Clock::now();
+};
+
+// Records [construction, destruction) as one zone; does nothing while the profiler is disabled.
+class ProfileZone {
+public:
+    ProfileZone(Profiler& profiler, const char* name)
+        : profiler_(profiler.enabled() ? &profiler : nullptr), name_(name),
+          start_(profiler_ ? profiler.now() : 0) {}
+    ~ProfileZone() {
+        if (profiler_) profiler_->zone(name_, start_, profiler_->now());
+    }
+
+    ProfileZone(const ProfileZone&) = delete;
+    ProfileZone& operator=(const ProfileZone&) = delete;
+
+private:
+    Profiler* profiler_;
+    const char* name_;
+    int64_t start_;
+};
+
+#endif // PROFILER_H
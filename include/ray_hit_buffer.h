@@ -0,0 +1,45 @@
+#ifndef RAY_HIT_BUFFER_H
+#define RAY_HIT_BUFFER_H
+
+#include <cstdint>
+#include <memory>
+
+/*
+ * One frame of ray results, one entry per screen column, stored as separate 64-byte-aligned
+ * arrays (struct of arrays) so each consumer streams only the fields it reads. The caller
+ * owns it and reuses it every frame; resize() allocates only when the column count grows,
+ * so steady-state frames make no heap allocations.
+ */
+class RayHitBuffer {
+public:
+    RayHitBuffer() = default;
+    explicit RayHitBuffer(int columns) { resize(columns); }
+
+    void resize(int columns);
+    int columns() const { return columns_; }
+
+    float* distance() { return distance_; }  // Perpendicular distance; maxDepth if nothing was hit
+    float* height() { return height_; }      // Projected wall height in pixels
+    uint8_t* cell() { return cell_; }        // Cell type that stopped the ray (Cell::Empty if none)
+    uint8_t* side() { return side_; }        // 0 = x face, 1 = y face
+    float* texU() { return texU_; }          // Position across the hit face in [0, 1)
+
+    const float* distance() const { return distance_; }
+    const float* height() const { return height_; }
+    const uint8_t* cell() const { return cell_; }
+    const uint8_t* side() const { return side_; }
+    const float* texU() const { return texU_; }
+
+private:
+    struct AlignedFree { void operator()(uint8_t* p) const; };
+    std::unique_ptr<uint8_t, AlignedFree> storage_;
+    int columns_ = 0;
+    int capacity_ = 0;
+    float* distance_ = nullptr;
+    float* height_ = nullptr;
+    uint8_t* cell_ = nullptr;
+    uint8_t* side_ = nullptr;
+    float* texU_ = nullptr;
+};
+
+#endif // RAY_HIT_BUFFER_H
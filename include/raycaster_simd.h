@@ -0,0 +1,22 @@
+#ifndef RAYCASTER_SIMD_H
+#define RAYCASTER_SIMD_H
+
+#include "raycaster.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define RAYCASTER_X86_SIMD 1
+
+/*
+ * Packet DDA kernels: trace 4 (SSE2) or 8 (AVX2) rays from one origin in lockstep.
+ * Lanes terminate independently (masked); the packet finishes when every lane has hit a
+ * wall or passed maxDepth. Per-lane arithmetic mirrors Raycaster::castRayDda exactly.
+ * Only call a kernel if detectSimdIsa() reported support for it.
+ */
+void tracePacketSse2(const CellGrid& grid, float originX, float originY,
+                     const float* dirX, const float* dirY, float maxDepth, RayHit* out);
+void tracePacketAvx2(const CellGrid& grid, float originX, float originY,
+                     const float* dirX, const float* dirY, float maxDepth, RayHit* out);
+
+#endif
+
+#endif // RAYCASTER_SIMD_H
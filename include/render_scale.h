@@ -0,0 +1,61 @@
+#ifndef RENDER_SCALE_H
+#define RENDER_SCALE_H
+
+/*
+ * Dynamic resolution: picks the fraction of the output resolution the 3D view is cast and
+ * shaded at, per axis, from how long recent frames took to render against a frame budget.
+ * The renderers draw the view at scaled() size and stretch it to the window; HUD and
+ * minimap stay at full resolution.
+ *
+ * Cost is modelled as proportional to pixel count (scale squared). Hysteresis keeps the
+ * scale from oscillating: it drops after a short window over highWater of the budget, but
+ * rises only after a long window in which the next step up is predicted to stay under
+ * lowWater, and frames rendered just after a change (GPU timers lag by a frame or two)
+ * are not measured.
+ */
+class RenderScale {
+public:
+    struct Config {
+        double minScale = 0.5;
+        double maxScale = 1.0;
+        double step = 0.1;        // Smallest change; a step up is exactly one step
+        double highWater = 0.9;   // Fraction of the budget that triggers a step down
+        double lowWater = 0.7;    // Predicted fraction of the budget a step up must stay under
+        int downFrames = 15;      // Frames averaged before stepping down
+        int upFrames = 120;       // Frames averaged before stepping up
+        int settleFrames = 4;     // Frames ignored after a change
+    };
+
+    RenderScale() = default;
+    explicit RenderScale(const Config& config) : config_(config), scale_(config.maxScale) {}
+
+    void setBudget(double ms) { budgetMs_ = ms; }
+    void setFixed(double scale);  // Pin the scale (clamped to [0.1, 1]); update() stops adjusting
+    void setAdaptive();           // Back to maxScale, adjusted by update()
+
+    // Render time of the frame just drawn at the current scale. Returns true when scale()
+    // changed for the next frame.
+    bool update(double workMs);
+
+    double scale() const { return scale_; }
+    bool adaptive() const { return adaptive_; }
+    double budgetMs() const { return budgetMs_; }
+    double averageMs() const { return mean(count_); }  // Over the frames measured at this scale, up to kHistory
+    int scaled(int size) const;  // size * scale, at least 1
+
+private:
+    static constexpr int kHistory = 128;
+
+    double mean(int frames) const;  // Of the last frames measured
+    void change(double scale);
+
+    Config config_;
+    double scale_ = 1.0;
+    double budgetMs_ = 1000.0 / 60.0;
+    bool adaptive_ = true;
+    float history_[kHistory] = {};
+    int count_ = 0;   // Frames measured at this scale (negative while settling)
+    int next_ = 0;    // Ring position of the next measurement
+};
+
+#endif // RENDER_SCALE_H
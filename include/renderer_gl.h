@@ -1,6 +1,7 @@
 #ifndef RENDERER_GL_H
 #define RENDERER_GL_H
 
+class Map;
 class Player;
 
 class RendererGL {
@@ -8,17 +9,40 @@ public:
     RendererGL() = default;
     ~RendererGL();
 
-    bool init(int width, int height);
-    void draw(const Player& player, bool hasKey, int winWidth, int winHeight);
+    bool init(int width, int height, const Map& map);
+    // The 3D view is cast and shaded at scale x the window size (per axis); below 1 it is
+    // drawn into an offscreen target and stretched to the window, the minimap stays sharp.
+    void draw(const Player& player, bool hasKey, int winWidth, int winHeight, float scale = 1.0f);
     void drawTitleScreen(int winWidth, int winHeight);
     void drawWinScreen(int winWidth, int winHeight);
     void resize(int width, int height);
 
+    // GPU time of the last measured frame's column cast and shading passes (timer queries,
+    // read back without stalling, so a frame or two behind).
+    float castGpuMs() const { return castGpuMs_; }
+    float shadeGpuMs() const { return shadeGpuMs_; }
+
 private:
-    unsigned int program_ = 0;
+    unsigned int castProgram_ = 0;   // Pass 1: one DDA per column into hitTex_
+    unsigned int program_ = 0;       // Pass 2: projection, shading and fog from hitTex_
+    unsigned int hitTex_ = 0;        // columns x 1 RGBA32F: distance, cell type, side, texture u
+    unsigned int columnTex_ = 0;     // columns x 1 RGBA32F: lit wall color, half wall height (px)
+    unsigned int hitFbo_ = 0;
+    int hitColumns_ = 0;
+    int maxColumns_ = 0;             // GL_MAX_TEXTURE_SIZE; wider windows share columns
+    unsigned int sceneTex_ = 0;      // Scaled view, RGBA8, stretched to the window by a blit
+    unsigned int sceneFbo_ = 0;
+    int sceneWidth_ = 0;
+    int sceneHeight_ = 0;
+    unsigned int timerQueries_[2] = {0, 0};
+    bool timerPending_ = false;
+    float castGpuMs_ = 0.0f;
+    float shadeGpuMs_ = 0.0f;
     unsigned int vao_ = 0;
     unsigned int vbo_ = 0;
     unsigned int mapTex_ = 0;
+    unsigned int fieldTex_ = 0;      // Distance field for empty-space skipping
+    unsigned int fieldRevision_ = 0; // DistanceField::revision() last uploaded
     unsigned int minimapProgram_ = 0;
     unsigned int minimapVao_ = 0;
     unsigned int minimapVbo_ = 0;
@@ -27,11 +51,17 @@ private:
     unsigned int solidVbo_ = 0;
     int winWidth_ = 0;
     int winHeight_ = 0;
+    const Map* map_ = nullptr;  // Level shown; must outlive the renderer
 
+    static unsigned int linkProgram(const char* vert, const char* frag);
     bool loadShaders();
+    bool ensureHitTarget(int columns);
+    bool ensureSceneTarget(int width, int height);
+    void readTimers();
     bool loadMinimapShaders();
     bool loadSolidShaders();
     void uploadMapTexture();
+    void uploadFieldTexture();
     void drawMinimap(const Player& player, bool hasKey, int winWidth, int winHeight);
 };
 
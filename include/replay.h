@@ -0,0 +1,125 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "game_session.h"
+
+class Map;
+
+/*
+ * Replay file (.rcr), version 1, little-endian. A fixed 128-byte header, then the
+ * per-tick inputs of one run from its first tick. The header carries what a replay needs
+ * to be checked on its own: the level it was played on, the tick rate and mouse scale the
+ * inputs are in, and the outcome claimed for the last tick.
+ *
+ * Inputs are delta-encoded: a tick that holds the same buttons as the one before and has
+ * no mouse motion is not stored. Every other tick is a record:
+ *
+ *   varint  ticks skipped since the previous record (they repeat its buttons)
+ *   byte    buttons | 0x80 if the mouse moved
+ *   varint  zigzag mouse delta in pixels (only with 0x80)
+ *
+ * Ticks after the last record repeat its buttons up to tickCount. A two-minute run at
+ * 120 Hz is 14400 ticks and typically a few kilobytes.
+ */
+struct ReplayHeader {
+    char magic[8];              // "RCREPLAY"
+    uint32_t version;           // kVersion
+    uint32_t headerBytes;       // sizeof(ReplayHeader)
+    uint32_t ticksPerSecond;    // Fixed tick the inputs were sampled at
+    uint32_t tickCount;
+    uint64_t levelHash;         // levelFingerprint() of the map played
+    int32_t levelWidth, levelHeight;
+    double mouseSensitivity;    // Radians per pixel of mouse delta
+    double finalX, finalY, finalAngle;  // Outcome after the last tick, checked by verify()
+    int32_t score;
+    uint8_t hasKey, hasWon, hasLost, reserved0;
+    uint64_t inputBytes;        // Encoded input stream following the header
+    uint8_t reserved[40];
+
+    static constexpr uint32_t kVersion = 1;
+};
+static_assert(sizeof(ReplayHeader) == 128, "replay header layout is part of the file format");
+
+// What one tick was given: the Button bits held and horizontal mouse motion since the
+// previous tick. The game and every playback path turn it into a SessionInput the same way.
+struct TickInput {
+    uint8_t buttons = 0;
+    int32_t mouseDx = 0;
+
+    SessionInput toSession(const GameSession& session, double mouseSensitivity) const {
+        SessionInput input;
+        input.buttons = buttons & Button::All;
+        input.angle = session.player().angle + mouseDx * mouseSensitivity;
+        return input;
+    }
+};
+
+// Hash of a level's size, spawn point and cell storage; a replay only plays on the level
+// it was recorded on.
+uint64_t levelFingerprint(const Map& map);
+
+// Appends ticks in memory while a run is played; save() writes the file with the outcome.
+class ReplayWriter {
+public:
+    ReplayWriter(const Map& map, uint32_t ticksPerSecond, double mouseSensitivity);
+
+    void record(const TickInput& input);
+    bool save(const std::string& path, const GameSession& finalState) const;
+    uint32_t ticks() const { return ticks_; }
+    size_t inputBytes() const { return bytes_.size(); }
+
+private:
+    ReplayHeader header_;
+    std::vector<uint8_t> bytes_;
+    uint32_t ticks_ = 0;
+    uint32_t skipped_ = 0;  // Unchanged ticks since the last record
+    uint8_t buttons_ = 0;   // Buttons of the last record
+};
+
+class Replay {
+public:
+    // Reads and checks the header, including that the inputs were sampled at
+    // GameSession::kTicksPerSecond; on failure the replay is unchanged.
+    bool load(const std::string& path);
+    const ReplayHeader& header() const { return header_; }
+    double tickSeconds() const { return 1.0 / header_.ticksPerSecond; }
+
+    // Decodes the inputs in order; next() is false after tickCount ticks or on a corrupt stream.
+    class Cursor {
+    public:
+        explicit Cursor(const Replay& replay);
+        bool next(TickInput& input);
+        bool corrupt() const { return corrupt_; }
+        uint32_t tick() const { return tick_; }
+
+    private:
+        bool readVarint(uint32_t& value);
+
+        const uint8_t* pos_;
+        const uint8_t* end_;
+        uint32_t count_;
+        uint32_t tick_ = 0;
+        uint32_t untilRecord_ = 0;  // Unchanged ticks before the next record
+        bool haveRecord_ = false;   // untilRecord_ counts down to a record (not the end of the stream)
+        bool corrupt_ = false;
+        uint8_t buttons_ = 0;
+    };
+
+    // Whether a session that played every tick ended in the recorded state: position
+    // exactly (same inputs, same arithmetic), key, outcome and score. why says what differed.
+    bool matches(const GameSession& session, std::string* why = nullptr) const;
+    // Plays every tick on a fresh session over map (which must be the recorded level, with
+    // levelHash its levelFingerprint()) and checks the outcome with matches(). ticksPlayed
+    // is how many ticks were simulated: 0 for another level, fewer than tickCount if corrupt.
+    bool verify(const Map& map, uint64_t levelHash, std::string* why = nullptr,
+                uint32_t* ticksPlayed = nullptr) const;
+
+private:
+    ReplayHeader header_{};
+    std::vector<uint8_t> inputs_;
+};
+
+#endif // REPLAY_H
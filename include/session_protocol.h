@@ -0,0 +1,81 @@
+#ifndef SESSION_PROTOCOL_H
+#define SESSION_PROTOCOL_H
+
+#include <cstddef>
+#include <cstdint>
+
+/*
+ * Session server wire protocol, over a Unix-domain stream socket. Each message is a
+ * one-byte type and a fixed-size body, packed, in host byte order (both ends are on the
+ * same machine); messageSize() gives the size from the type byte alone, so a reader never
+ * needs a length prefix. One connection may own any number of sessions.
+ *
+ *   client -> server   Join, Input (latest one is held until replaced), Leave
+ *   server -> client   Joined (or Rejected), then one State per owned session per tick
+ */
+namespace SessionProtocol {
+
+constexpr const char* kDefaultSocket = "/tmp/raycaster-sessions.sock";
+constexpr uint32_t kNoSession = 0xFFFFFFFFu;
+
+enum Type : uint8_t { Join = 1, Input = 2, Leave = 3, Joined = 128, State = 129 };
+
+// StateMsg::flags
+enum Flag : uint8_t { HasKey = 1, Won = 2, Lost = 4 };
+
+#pragma pack(push, 1)
+struct JoinMsg {
+    uint8_t type = Join;
+    uint32_t token = 0;  // Echoed in Joined, to match replies to requests
+};
+struct JoinedMsg {
+    uint8_t type = Joined;
+    uint32_t token = 0;
+    uint32_t session = kNoSession;  // kNoSession: the server is full
+};
+struct InputMsg {
+    uint8_t type = Input;
+    uint32_t session = 0;
+    uint32_t sequence = 0;  // Echoed in State::ackSequence once the input has been ticked
+    uint8_t buttons = 0;    // Button bits from game_session.h; others are ignored
+    uint16_t angle = 0;     // Turns / 65536
+};
+struct LeaveMsg {
+    uint8_t type = Leave;
+    uint32_t session = 0;
+};
+struct StateMsg {
+    uint8_t type = State;
+    uint32_t session = 0;
+    uint32_t tick = 0;
+    uint32_t ackSequence = 0;  // Latest input applied
+    float x = 0.0f, y = 0.0f;
+    uint16_t angle = 0;        // Turns / 65536
+    uint8_t flags = 0;         // Flag bits
+    uint16_t score = 0;
+    uint32_t timeLeftMs = 0;
+    uint32_t elapsedMs = 0;
+};
+#pragma pack(pop)
+
+// Body size including the type byte; 0 for an unknown type.
+inline size_t messageSize(uint8_t type) {
+    switch (type) {
+    case Join: return sizeof(JoinMsg);
+    case Input: return sizeof(InputMsg);
+    case Leave: return sizeof(LeaveMsg);
+    case Joined: return sizeof(JoinedMsg);
+    case State: return sizeof(StateMsg);
+    default: return 0;
+    }
+}
+
+inline uint16_t encodeAngle(double radians) {
+    const double turns = radians / 6.283185307179586;
+    return static_cast<uint16_t>(static_cast<int64_t>(turns * 65536.0 + (turns < 0 ? -0.5 : 0.5)));
+}
+inline double decodeAngle(uint16_t angle) { return static_cast<int16_t>(angle) * (6.283185307179586 / 65536.0); }
+
+} // namespace SessionProtocol
+
+#endif // SESSION_PROTOCOL_H
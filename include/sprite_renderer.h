@@ -0,0 +1,66 @@
+#ifndef SPRITE_RENDERER_H
+#define SPRITE_RENDERER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "raycaster.h"
+
+class Framebuffer;
+class ThreadPool;
+class WallTextures;
+
+// A billboard standing on the floor, always facing the camera.
+struct Sprite {
+    float x = 0.0f, y = 0.0f;  // World position of its center
+    float size = 1.0f;         // Width and height in cells
+    uint8_t texture = 0;       // WallTextures::SpriteTexture
+};
+
+/*
+ * Draws billboards over the CPU frame, using the per-column wall distances from the
+ * raycaster as a 1D z-buffer. Per frame: project every sprite and drop the ones behind
+ * the camera, past maxDepth or off the sides of the screen; drop the ones hidden behind
+ * walls using the farthest wall distance per 16-column tile, before any pixel is
+ * touched; radix-sort the rest by depth and draw them far to near, skipping every
+ * column where a wall is closer and the rows outside the texture's opaque spans.
+ * Drawing is split into bands of 64 columns on the pool and goes row by row within a
+ * band, so stores run along the framebuffer. Scratch space is kept between frames, so
+ * drawing does not allocate once it has seen its largest sprite count.
+ */
+class SpriteRenderer {
+public:
+    struct Stats {
+        int visible = 0;   // Passed the frustum test
+        int occluded = 0;  // Of those, hidden behind walls
+        int drawn = 0;     // Visible in at least one column
+    };
+
+    // depth: perpendicular wall distance for each of fb.width() columns. pool may be null.
+    Stats draw(Framebuffer& fb, const Raycaster::Camera& cam, float maxDepth, const float* depth,
+               const Sprite* sprites, size_t count, const WallTextures& textures, ThreadPool* pool);
+
+private:
+    static constexpr int kTileLog2 = 4;  // Occlusion tiles of 16 columns
+    static constexpr int kBandLog2 = 6;  // Parallel drawing bands of 64 columns
+
+    struct Projected {
+        float depth;     // Perpendicular distance
+        float screenX;   // Left edge, in pixels (may be off-screen)
+        float width;     // In pixels
+        int x0, x1;      // Clipped column range [x0, x1)
+        uint32_t sprite; // Index into the caller's array
+    };
+
+    void sortByDepth();  // Far to near
+    // Columns [x0, x1) of one sprite, all within one band.
+    static void drawSprite(Framebuffer& fb, const Projected& p, const Sprite& s, int x0, int x1,
+                           const float* depth, const WallTextures& textures);
+
+    std::vector<float> tileDepth_;   // Farthest wall in each column tile
+    std::vector<Projected> visible_;
+    std::vector<Projected> sorted_;  // Radix sort ping-pong buffer
+    std::vector<uint32_t> keys_, sortedKeys_;
+};
+
+#endif // SPRITE_RENDERER_H
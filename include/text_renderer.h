@@ -0,0 +1,97 @@
+#ifndef TEXT_RENDERER_H
+#define TEXT_RENDERER_H
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#ifdef HAS_SDL2_TTF
+#include <SDL2/SDL_ttf.h>
+#else
+typedef struct _TTF_Font TTF_Font;  // Always null without SDL_ttf
+#endif
+
+class Framebuffer;
+
+/*
+ * Cached text for the CPU frame. Glyphs are rasterized once per (font, size, glyph) into
+ * an 8-bit coverage atlas: TrueType glyphs through SDL_ttf, block-font glyphs from the
+ * built-in 5x7 table at each block size. A string is composed from the atlas into an
+ * ARGB image once and kept, keyed on its font, color and text, so a label that does not
+ * change costs one blit of its lit runs per frame; a changing one (the timer) is
+ * recomposed from the atlas without touching the font. Strings not drawn for a while are dropped in
+ * endFrame().
+ */
+class TextRenderer {
+public:
+    struct Stats {
+        int strings = 0;   // Blended this frame
+        int composed = 0;  // Of those, not in the string cache
+        int glyphs = 0;    // Rasterized into the atlas this frame
+    };
+
+    // The font is borrowed; null means block text only. Changing it drops the caches.
+    void setFont(TTF_Font* font);
+    TTF_Font* font() const { return font_; }
+
+    // TrueType text at fontSize points; (x, y) is the left edge (or the center when centerX)
+    // and the vertical middle of the line. Does nothing without a font.
+    void draw(Framebuffer& fb, const char* text, int x, int y, int fontSize, uint32_t color, bool centerX);
+    // 5x7 block-font text, each lit cell blockW x blockH, gap pixels between characters;
+    // (x, y) is the top-left corner, or the center when centered.
+    void drawBlock(Framebuffer& fb, const char* text, int x, int y, int blockW, int blockH, int gap,
+                   uint32_t color, bool centered);
+
+    // Ages the string cache and returns this frame's counts.
+    Stats endFrame();
+
+private:
+    static constexpr int kAtlasSize = 512;      // Coverage atlas is kAtlasSize x kAtlasSize bytes
+    static constexpr int kMaxIdleFrames = 120;  // Cached strings not drawn for this long are dropped
+
+    struct Glyph {
+        int16_t atlasX = 0, atlasY = 0;
+        int16_t w = 0, h = 0;  // Coverage box; its top-left sits at the pen position, top of line
+        int16_t advance = 0;
+    };
+    // A composed string, kept as runs: solid ones (identical runs on consecutive rows merged
+    // into one rectangle) are filled with the color, anti-aliased ones blended from pixels.
+    // Cost follows the lit area, not the box.
+    struct Run {
+        int16_t x0, x1, y, h;  // Columns [x0, x1) of rows [y, y + h)
+        bool solid;
+    };
+    struct Image {
+        std::vector<uint32_t> pixels;  // ARGB, straight alpha
+        std::vector<Run> runs;
+        int w = 0, h = 0;
+        uint32_t color = 0;
+        uint64_t lastFrame = 0;
+    };
+
+    const Glyph& glyph(uint32_t font, uint32_t codepoint);
+    bool rasterize(uint32_t font, uint32_t codepoint, Glyph& g);
+    bool allocate(int w, int h, Glyph& g);  // Shelf-packs a box into the atlas
+    const Image& string(uint32_t font, const char* text, uint32_t color);
+    void compose(uint32_t font, const char* text, uint32_t color, Image& image);
+    static void blit(Framebuffer& fb, const Image& image, int x, int y);
+    int lineHeight(uint32_t font);
+
+    TTF_Font* font_ = nullptr;
+    int fontSize_ = 0;  // Size font_ is currently set to
+
+    std::vector<uint8_t> atlas_ = std::vector<uint8_t>(static_cast<size_t>(kAtlasSize) * kAtlasSize);
+    int shelfX_ = 0, shelfY_ = 0, shelfH_ = 0;
+    uint32_t atlasGeneration_ = 0;  // Bumped whenever a full atlas is cleared
+    std::unordered_map<uint64_t, Glyph> glyphs_;  // (font << 32) | codepoint
+    std::unordered_map<uint32_t, int> lineHeights_;
+    std::unordered_map<std::string, Image> strings_;
+    std::string key_;  // Lookup scratch
+    std::vector<std::pair<Glyph, int>> layout_;  // Compose scratch: glyph and pen x
+    std::vector<Run> open_, next_;                // Compose scratch: solid runs that may grow down
+
+    uint64_t frame_ = 1;
+    Stats stats_;
+};
+
+#endif // TEXT_RENDERER_H
@@ -0,0 +1,73 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <type_traits>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+ * Persistent worker pool for data-parallel loops (e.g. ray casting by column tile).
+ * parallelFor() splits [0, count) into tiles, deals each participant a contiguous run of
+ * tiles, and lets participants that finish early steal from the back of other runs.
+ * The calling thread participates, so a pool with N workers runs N + 1 tiles at once.
+ */
+class ThreadPool {
+public:
+    // workers = number of background threads (0 = run everything on the caller).
+    explicit ThreadPool(int workers);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    int workerCount() const { return static_cast<int>(threads_.size()); }
+    int concurrency() const { return workerCount() + 1; }
+
+    // Call fn(begin, end) for consecutive ranges of at most `grain` items covering [0, count).
+    // Blocks until every range has completed. Not reentrant. Does not allocate.
+    template <class Fn>
+    void parallelFor(int count, int grain, Fn&& fn) {
+        using F = std::remove_reference_t<Fn>;
+        run(count, grain, [](void* ctx, int begin, int end) { (*static_cast<F*>(ctx))(begin, end); },
+            const_cast<void*>(static_cast<const void*>(&fn)));
+    }
+
+private:
+    using TaskFn = void (*)(void* ctx, int begin, int end);
+
+    void run(int count, int grain, TaskFn fn, void* ctx);
+    // One participant's run of tiles, packed as (begin << 32 | end) so the owner (front)
+    // and thieves (back) can both claim a tile with a single CAS.
+    struct alignas(64) Run {
+        std::atomic<uint64_t> range{0};
+    };
+
+    void workerLoop(int slot);
+    void runSlot(int slot);
+    void runTile(int tile);
+    bool popFront(int slot, int& tile);
+    bool stealBack(int victim, int& tile);
+
+    std::vector<std::thread> threads_;
+    std::unique_ptr<Run[]> runs_;
+
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+    uint64_t generation_ = 0;
+    bool stopping_ = false;
+
+    // Current job (valid while a parallelFor is in flight).
+    TaskFn fn_ = nullptr;
+    void* ctx_ = nullptr;
+    int count_ = 0;
+    int grain_ = 1;
+    int activeWorkers_ = 0;
+};
+
+#endif // THREAD_POOL_H
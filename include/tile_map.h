@@ -0,0 +1,88 @@
+#ifndef TILE_MAP_H
+#define TILE_MAP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace Cell { enum { Empty = 0, Wall = 1, Door = 2, Key = 3, Exit = 4 }; }
+
+// Read-only view of a TileMap for one key state: the grid callable the raycaster traverses.
+// grid(x, y) returns the cell type that stops a ray in (x, y), or 0 if the ray passes;
+// outside the map reads as Wall. Traversal only touches the bitplane; the cell byte is
+// loaded once, for the cell that was hit.
+struct CellGrid {
+    const uint8_t* cells = nullptr;     // TileMap cell bytes, tile-major
+    const uint64_t* blocking = nullptr;  // One word per tile, bit = (y & 7) * 8 + (x & 7)
+    int tilesX = 0;
+    int width = 0;
+    int height = 0;
+
+    bool inside(int x, int y) const {
+        return static_cast<unsigned>(x) < static_cast<unsigned>(width) &&
+               static_cast<unsigned>(y) < static_cast<unsigned>(height);
+    }
+    static int tile(int x, int y, int tilesX) { return (y >> 3) * tilesX + (x >> 3); }
+    static int bit(int x, int y) { return ((y & 7) << 3) | (x & 7); }
+
+    int cell(int x, int y) const {
+        if (!inside(x, y)) return Cell::Wall;
+        return cells[static_cast<size_t>(tile(x, y, tilesX)) * 64 + bit(x, y)];
+    }
+    int operator()(int x, int y) const {
+        if (!inside(x, y)) return Cell::Wall;
+        const int t = tile(x, y, tilesX), b = bit(x, y);
+        return ((blocking[t] >> b) & 1) ? cells[static_cast<size_t>(t) * 64 + b] : 0;
+    }
+};
+
+/*
+ * Map storage: 1 byte per cell in 8x8 tiles, so each tile is one 64-byte cache line and
+ * a ray crossing a tile touches one line instead of up to eight rows. Alongside the cells
+ * it keeps a 64-bit "blocking" bitplane per tile for each key state (without key: walls and
+ * the locked door; with key: walls only), so collision and ray queries are one load and a
+ * bit test with no branching on cell type. A 16k x 16k map's bitplane is 32 MB.
+ */
+class TileMap {
+public:
+    static constexpr int kTileSize = 8;
+    static constexpr int kTileCells = kTileSize * kTileSize;
+
+    TileMap() = default;
+    TileMap(int width, int height);                            // All Empty
+    TileMap(const int* rowMajor, int width, int height);       // Copy of a row-major grid
+
+    // Use storage laid out by storageBytes() in place (e.g. a mapped level file); not owned.
+    static TileMap view(uint8_t* storage, int width, int height);
+    // Cells, then the no-key bitplane, then the has-key bitplane; each section 64-byte aligned.
+    static size_t storageBytes(int width, int height);
+
+    int width() const { return width_; }
+    int height() const { return height_; }
+    size_t bytes() const { return storageBytes(width_, height_); }
+    const uint8_t* storage() const { return cells_; }
+
+    int cell(int x, int y) const { return grid(false).cell(x, y); }  // Wall outside the map
+    void setCell(int x, int y, int cell);                              // Keeps bitplanes in sync
+    bool blocks(int x, int y, bool hasKey) const { return grid(hasKey)(x, y) != Cell::Empty; }
+
+    CellGrid grid(bool hasKey) const;
+    void copyRows(uint8_t* dst) const;  // De-tile into width * height row-major bytes (GL upload)
+
+private:
+    static bool blocksWith(int cell, bool hasKey) {
+        return cell == Cell::Wall || (cell == Cell::Door && !hasKey);
+    }
+
+    void bind(uint8_t* storage, int width, int height);
+
+    struct AlignedFree { void operator()(uint8_t* p) const; };
+    std::unique_ptr<uint8_t, AlignedFree> owned_;  // Null for views
+    uint8_t* cells_ = nullptr;
+    uint64_t* blocking_[2] = {nullptr, nullptr};  // [hasKey]
+    int width_ = 0;
+    int height_ = 0;
+    int tilesX_ = 0;
+};
+
+#endif // TILE_MAP_H
@@ -0,0 +1,94 @@
+#ifndef VEC_ENV_H
+#define VEC_ENV_H
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "game_session.h"
+#include "raycaster.h"
+#include "thread_pool.h"
+
+class Map;
+
+/*
+ * N independent games stepped together, for training and evaluating agents without a
+ * window. Each environment is a GameSession on the shared (read-only) map; step() applies
+ * one action per environment, runs ticksPerStep fixed ticks, then writes observations into
+ * contiguous arrays indexed [env * stride + i], allocated once in the constructor and
+ * overwritten in place every step. Environments are stepped in parallel on a ThreadPool;
+ * each is independent, so results do not depend on the thread count.
+ *
+ * An episode ends when the player escapes or the timer runs out: done is set, reward
+ * includes the final outcome, and the environment is reset in the same step, so the
+ * observation is already the first of the next episode.
+ */
+class VecEnv {
+public:
+    // Action bits: the session's movement buttons, plus turning the view.
+    enum Action : uint8_t {
+        North = Button::North, South = Button::South, West = Button::West, East = Button::East,
+        TurnLeft = 32, TurnRight = 64,
+    };
+
+    struct Config {
+        int count = 256;                     // Environments
+        int rays = 64;                       // Columns of the ray (and frame) observation, up to kMaxRays
+        int frameHeight = 0;                 // Rows of the rendered frame; 0 = rays only
+        int ticksPerStep = 4;                // Fixed ticks per action (action repeat)
+        double tickSeconds = 1.0 / 120.0;    // Same tick as the game
+        double turnSpeed = 3.0;              // Radians per second while a turn bit is held
+        float maxDepth = 16.0f;              // Rays stop here; rayDistance() is maxDepth for no hit
+        float keyReward = 1.0f;
+        float exitReward = 1.0f;             // Plus the fraction of the time limit left
+        float timeoutReward = 0.0f;
+        float stepReward = 0.0f;             // Added every step (e.g. a small negative cost)
+        int threads = 0;                     // Total threads including the caller; 0 = all cores
+    };
+
+    static constexpr int kMaxRays = 1024;
+
+    VecEnv(const Map& map, const Config& config);
+
+    void reset();                        // Every environment to the spawn point; fills observations
+    void step(const uint8_t* actions);   // One Action bit set per environment
+
+    int count() const { return config_.count; }
+    int rays() const { return config_.rays; }
+    int frameHeight() const { return config_.frameHeight; }
+    const Config& config() const { return config_; }
+
+    // Observations, [env * rays + column]: perpendicular wall distance and the cell type
+    // that stopped the ray (Cell::Empty if nothing within maxDepth).
+    const float* rayDistance() const { return rayDistance_.data(); }
+    const uint8_t* rayCell() const { return rayCell_.data(); }
+    // [env * rays * frameHeight + row * rays + column]: 8-bit grey frame drawn from the
+    // same rays (empty when frameHeight is 0).
+    const uint8_t* frames() const { return frames_.data(); }
+    const float* pose() const { return pose_.data(); }        // [env * 3]: x, y, angle
+    const uint8_t* hasKey() const { return hasKey_.data(); }  // [env]
+    const float* reward() const { return reward_.data(); }    // [env], from the last step
+    const uint8_t* done() const { return done_.data(); }      // [env], episode ended in the last step
+    const GameSession& session(int env) const { return sessions_[env]; }
+
+private:
+    void stepRange(const uint8_t* actions, int begin, int end);
+    void observe(int env);
+
+    const Map* map_;
+    Config config_;
+    Raycaster caster_;
+    std::unique_ptr<ThreadPool> pool_;
+    std::vector<GameSession> sessions_;
+
+    std::vector<float> rayDistance_;
+    std::vector<uint8_t> rayCell_;
+    std::vector<uint8_t> frames_;
+    std::vector<float> pose_;
+    std::vector<uint8_t> hasKey_;
+    std::vector<float> reward_;
+    std::vector<uint8_t> done_;
+
+    static constexpr int kEnvTile = 16;  // Environments per work item
+};
+
+#endif // VEC_ENV_H
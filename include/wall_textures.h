@@ -0,0 +1,69 @@
+#ifndef WALL_TEXTURES_H
+#define WALL_TEXTURES_H
+
+#include <cstdint>
+#include <vector>
+#include "tile_map.h"
+
+/*
+ * Textures for the CPU renderer: one kSize x kSize texture per solid cell type (Wall,
+ * Door, Key, Exit), the floor and ceiling, and the sprites, generated at startup, stored
+ * as 8-bit palette indices in a column-major (transposed) atlas so one screen column
+ * reads one contiguous run of kSize bytes. Distance shading and fog are baked into
+ * kShadeLevels colormaps per face side, each mapping every palette index straight to an
+ * ARGB8888 pixel, so the inner loop is a byte load and a table load.
+ */
+class WallTextures {
+public:
+    static constexpr int kSizeLog2 = 6;
+    static constexpr int kSize = 1 << kSizeLog2;  // Texels per side (power of two)
+    static constexpr int kShadeLevels = 32;
+    static constexpr uint8_t kTransparent = 255;  // Sprite texels that are not drawn
+
+    enum SpriteTexture { kSpriteKey, kSpriteExit, kSpriteTextures };
+
+    // Builds the textures and the colormaps for distances up to maxDepth.
+    explicit WallTextures(float maxDepth);
+
+    // Texel column for face position u in [0, 1) of a cell type; kSize palette indices, top down.
+    const uint8_t* column(int cell, float u) const {
+        const int t = cell >= Cell::Wall && cell <= Cell::Exit ? cell - Cell::Wall : 0;
+        const int c = static_cast<int>(u * kSize) & (kSize - 1);
+        return &atlas_[(static_cast<size_t>(t) * kSize + c) * kSize];
+    }
+
+    // Floor / ceiling texture: texel (u, v) is at [(u << kSizeLog2) | v]. The atlas is padded
+    // so a 32-bit load at any texel stays in bounds (for gathers).
+    const uint8_t* floorTexture() const { return &atlas_[static_cast<size_t>(kFloor) * kSize * kSize]; }
+    const uint8_t* ceilingTexture() const { return &atlas_[static_cast<size_t>(kCeiling) * kSize * kSize]; }
+
+    // Column u (0..kSize-1) of a sprite texture; kTransparent marks holes.
+    const uint8_t* spriteColumn(int sprite, int u) const {
+        return &atlas_[(static_cast<size_t>(kFirstSprite + sprite) * kSize + u) * kSize];
+    }
+
+    // Rows [first, end) of a sprite column that hold opaque texels; first == end when the
+    // whole column is transparent.
+    struct Span { uint8_t first, end; };
+    Span spriteSpan(int sprite, int u) const { return spriteSpans_[static_cast<size_t>(sprite) * kSize + u]; }
+
+    // Palette-to-ARGB table for a surface at this distance; side 1 (y faces) is darker.
+    const uint32_t* colormap(float distance, int side) const {
+        int level = static_cast<int>(distance * levelScale_);
+        level = level < 0 ? 0 : (level >= kShadeLevels ? kShadeLevels - 1 : level);
+        return &colormaps_[(static_cast<size_t>(side ? 1 : 0) * kShadeLevels + level) * 256];
+    }
+
+private:
+    static constexpr int kFloor = Cell::Exit - Cell::Wall + 1;  // Wall textures come first
+    static constexpr int kCeiling = kFloor + 1;
+    static constexpr int kFirstSprite = kCeiling + 1;  // Sprites reuse the palette ramps of the others
+    static constexpr int kTextures = kFirstSprite + kSpriteTextures;
+
+    std::vector<uint8_t> atlas_;       // [texture][u][v]
+    std::vector<uint32_t> colormaps_;  // [side][level][palette index]
+    std::vector<Span> spriteSpans_;    // [sprite][u]
+    float levelScale_ = 0.0f;          // Shade levels per unit of distance
+};
+
+#endif // WALL_TEXTURES_H
@@ -0,0 +1,499 @@
+/*
+ * Session server: thousands of authoritative game sessions, no window or GPU.
+ * ---------------------------------------------------------------------------
+ *   session_server [--socket PATH] [--level file.lvl] [--hz 120] [--threads N]
+ *                  [--max-sessions N] [--report SECONDS]
+ *   session_server --bench SESSIONS [--seconds S] [--hz 120] [--threads N] [--level file.lvl]
+ *
+ * Every tick it drains the client sockets (joins, inputs, leaves), steps every live
+ * session with GameSession::tick on the worker pool, then sends each client the state of
+ * its sessions (wire format in session_protocol.h). Clients only send buttons; movement,
+ * collision, pickups and scoring happen here. Every --report seconds it prints tick
+ * latency percentiles and the CPU spent per session tick, as sessions per core at the
+ * tick rate, for sizing hosts. --bench steps scripted sessions back to back with no
+ * sockets and reports the same figures for the simulation alone.
+ *
+ * POSIX only (Unix-domain sockets); bench/session_load.cpp is a matching load client.
+ */
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "game_session.h"
+#include "map.h"
+#include "session_protocol.h"
+#include "thread_pool.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+namespace proto = SessionProtocol;
+
+constexpr size_t kMaxBacklog = size_t(1) << 20;  // Bytes queued for a client before its states are dropped
+constexpr int kIndexBits = 20;                    // Session id: slot generation above, slot index below
+constexpr uint32_t kIndexMask = (1u << kIndexBits) - 1;
+constexpr int kStepGrain = 256;                   // Sessions per parallelFor range
+
+std::atomic<bool> gRunning{true};
+void onSignal(int) { gRunning = false; }
+
+double cpuSeconds() {
+    timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+double millisecondsSince(Clock::time_point t) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - t).count();
+}
+
+struct Rng {
+    unsigned state;
+    unsigned next() { state ^= state << 13; state ^= state >> 17; state ^= state << 5; return state; }
+};
+
+// Tick work times over one report window, and the process CPU time spent in it.
+class TickStats {
+public:
+    void start() {
+        tickMs_.clear();
+        sessionTicks_ = 0;
+        late_ = 0;
+        wall_ = Clock::now();
+        cpu_ = cpuSeconds();
+    }
+    void add(double ms, size_t sessions) {
+        tickMs_.push_back(ms);
+        sessionTicks_ += sessions;
+    }
+    void late() { ++late_; }
+
+    void print(const char* label, double hz, size_t sessions, size_t clients) {
+        if (tickMs_.empty()) return;
+        const double wall = millisecondsSince(wall_) / 1000.0;
+        const double cpu = cpuSeconds() - cpu_;
+        std::vector<double> ms = tickMs_;
+        std::sort(ms.begin(), ms.end());
+        auto percentile = [&](double p) { return ms[std::min(ms.size() - 1, static_cast<size_t>(p * ms.size()))]; };
+        // CPU per session tick covers everything the process did: sockets, stepping, encoding.
+        const double nsPerSessionTick = sessionTicks_ ? cpu * 1e9 / static_cast<double>(sessionTicks_) : 0.0;
+        std::printf("%s: %zu sessions, %zu clients, %zu ticks | tick p50 %.3f p99 %.3f max %.3f ms (budget %.2f), "
+                    "%d late | %.0f ns CPU per session tick, %.2f cores busy | ~%.0f sessions/core at %.0f Hz\n",
+                    label, sessions, clients, ms.size(), percentile(0.5), percentile(0.99), ms.back(), 1000.0 / hz,
+                    late_, nsPerSessionTick, cpu / wall, nsPerSessionTick > 0 ? 1e9 / (nsPerSessionTick * hz) : 0.0, hz);
+        std::fflush(stdout);
+    }
+
+private:
+    std::vector<double> tickMs_;
+    size_t sessionTicks_ = 0;
+    int late_ = 0;
+    Clock::time_point wall_;
+    double cpu_ = 0.0;
+};
+
+class SessionServer {
+public:
+    SessionServer(const Map& map, int threads, size_t maxSessions)
+        : map_(map), pool_(std::max(threads, 1) - 1), maxSessions_(std::min<size_t>(maxSessions, kIndexMask)) {}
+    ~SessionServer();
+
+    bool listen(const std::string& path);
+    void run(double hz, double reportSeconds);
+
+private:
+    struct Slot {
+        explicit Slot(const Map& map) : session(map) {}
+        GameSession session;
+        SessionInput input;        // Latest input; held until the next one arrives
+        uint32_t ackSequence = 0;  // Its sequence number
+        uint32_t generation = 0;   // Bumped on every join, so stale ids miss
+        int client = -1;           // Owner; -1 while the slot is free
+    };
+    struct Client {
+        int fd = -1;
+        std::vector<uint8_t> in, out;
+        std::vector<uint32_t> slots;
+    };
+
+    uint32_t idOf(uint32_t slot) const { return (slots_[slot].generation << kIndexBits) | slot; }
+    Slot* find(int client, uint32_t id);
+    void acceptClients();
+    bool readClient(int client);
+    void handle(int client, const uint8_t* message);
+    void join(int client, uint32_t token);
+    void leave(int client, uint32_t id);
+    void drop(int client);
+    void sendStates(uint32_t tick);
+    bool flush(Client& c);
+    template <class T> static void append(std::vector<uint8_t>& out, const T& message) {
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&message);
+        out.insert(out.end(), bytes, bytes + sizeof message);
+    }
+
+    const Map& map_;
+    ThreadPool pool_;
+    size_t maxSessions_;
+    std::vector<Slot> slots_;
+    std::vector<uint32_t> freeSlots_;
+    size_t liveSessions_ = 0;
+    std::vector<Client> clients_;
+    std::vector<int> freeClients_;
+    size_t liveClients_ = 0;
+    std::vector<pollfd> pollFds_;
+    int listenFd_ = -1;
+    std::string path_;
+    long long rejected_ = 0;  // Inputs and leaves naming a session the client does not own
+    long long dropped_ = 0;   // States not sent to clients that stopped reading
+};
+
+SessionServer::~SessionServer() {
+    for (Client& c : clients_)
+        if (c.fd >= 0) close(c.fd);
+    if (listenFd_ >= 0) {
+        close(listenFd_);
+        unlink(path_.c_str());
+    }
+}
+
+bool SessionServer::listen(const std::string& path) {
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof addr.sun_path) {
+        std::fprintf(stderr, "Socket path too long: %s\n", path.c_str());
+        return false;
+    }
+    std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+    listenFd_ = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listenFd_ < 0) {
+        std::perror("socket");
+        return false;
+    }
+    unlink(path.c_str());  // A stale socket from a previous run
+    if (bind(listenFd_, reinterpret_cast<sockaddr*>(&addr), sizeof addr) != 0 || ::listen(listenFd_, 128) != 0) {
+        std::perror(path.c_str());
+        return false;
+    }
+    fcntl(listenFd_, F_SETFL, fcntl(listenFd_, F_GETFL) | O_NONBLOCK);
+    path_ = path;
+    return true;
+}
+
+SessionServer::Slot* SessionServer::find(int client, uint32_t id) {
+    const uint32_t index = id & kIndexMask;
+    if (index >= slots_.size() || slots_[index].client != client || idOf(index) != id) return nullptr;
+    return &slots_[index];
+}
+
+void SessionServer::acceptClients() {
+    for (;;) {
+        const int fd = accept(listenFd_, nullptr, nullptr);
+        if (fd < 0) return;  // EAGAIN: none left
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+        int index;
+        if (!freeClients_.empty()) {
+            index = freeClients_.back();
+            freeClients_.pop_back();
+        } else {
+            index = static_cast<int>(clients_.size());
+            clients_.emplace_back();
+        }
+        clients_[index].fd = fd;
+        ++liveClients_;
+    }
+}
+
+bool SessionServer::readClient(int client) {
+    Client& c = clients_[client];
+    uint8_t buffer[64 * 1024];
+    for (;;) {
+        const ssize_t n = read(c.fd, buffer, sizeof buffer);
+        if (n > 0) c.in.insert(c.in.end(), buffer, buffer + n);
+        else if (n == 0) return false;  // Closed
+        else if (errno == EINTR) continue;
+        else if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+        else return false;
+    }
+    size_t pos = 0;
+    while (pos < c.in.size()) {
+        const uint8_t type = c.in[pos];
+        if (type != proto::Join && type != proto::Input && type != proto::Leave) return false;  // Not a client message
+        const size_t size = proto::messageSize(type);
+        if (c.in.size() - pos < size) break;
+        handle(client, &c.in[pos]);
+        pos += size;
+    }
+    c.in.erase(c.in.begin(), c.in.begin() + pos);
+    return true;
+}
+
+void SessionServer::handle(int client, const uint8_t* message) {
+    switch (message[0]) {
+    case proto::Join: {
+        proto::JoinMsg m;
+        std::memcpy(&m, message, sizeof m);
+        join(client, m.token);
+        break;
+    }
+    case proto::Input: {
+        proto::InputMsg m;
+        std::memcpy(&m, message, sizeof m);
+        Slot* slot = find(client, m.session);
+        if (!slot) {
+            ++rejected_;
+            break;
+        }
+        slot->input.buttons = m.buttons & Button::All;
+        slot->input.angle = proto::decodeAngle(m.angle);
+        slot->ackSequence = m.sequence;
+        break;
+    }
+    case proto::Leave: {
+        proto::LeaveMsg m;
+        std::memcpy(&m, message, sizeof m);
+        leave(client, m.session);
+        break;
+    }
+    }
+}
+
+void SessionServer::join(int client, uint32_t token) {
+    proto::JoinedMsg reply;
+    reply.token = token;
+    if (!freeSlots_.empty() || slots_.size() < maxSessions_) {
+        uint32_t index;
+        if (!freeSlots_.empty()) {
+            index = freeSlots_.back();
+            freeSlots_.pop_back();
+        } else {
+            index = static_cast<uint32_t>(slots_.size());
+            slots_.emplace_back(map_);
+        }
+        Slot& slot = slots_[index];
+        slot.session.reset();
+        slot.input = SessionInput{};
+        slot.input.angle = slot.session.player().angle;
+        slot.ackSequence = 0;
+        slot.generation = (slot.generation + 1) & (0xFFFFFFFFu >> kIndexBits);
+        slot.client = client;
+        clients_[client].slots.push_back(index);
+        ++liveSessions_;
+        reply.session = idOf(index);
+    }
+    append(clients_[client].out, reply);
+}
+
+void SessionServer::leave(int client, uint32_t id) {
+    Slot* slot = find(client, id);
+    if (!slot) {
+        ++rejected_;
+        return;
+    }
+    const uint32_t index = id & kIndexMask;
+    std::vector<uint32_t>& owned = clients_[client].slots;
+    owned.erase(std::find(owned.begin(), owned.end(), index));
+    slot->client = -1;
+    freeSlots_.push_back(index);
+    --liveSessions_;
+}
+
+void SessionServer::drop(int client) {
+    Client& c = clients_[client];
+    for (uint32_t index : c.slots) {
+        slots_[index].client = -1;
+        freeSlots_.push_back(index);
+        --liveSessions_;
+    }
+    close(c.fd);
+    c = Client{};
+    freeClients_.push_back(client);
+    --liveClients_;
+}
+
+bool SessionServer::flush(Client& c) {
+    size_t sent = 0;
+    while (sent < c.out.size()) {
+        const ssize_t n = send(c.fd, c.out.data() + sent, c.out.size() - sent, MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (n > 0) sent += static_cast<size_t>(n);
+        else if (n < 0 && errno == EINTR) continue;
+        else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+        else return false;
+    }
+    c.out.erase(c.out.begin(), c.out.begin() + sent);
+    return true;
+}
+
+void SessionServer::sendStates(uint32_t tick) {
+    for (int client = 0; client < static_cast<int>(clients_.size()); ++client) {
+        Client& c = clients_[client];
+        if (c.fd < 0) continue;
+        if (c.out.size() > kMaxBacklog) {
+            dropped_ += static_cast<long long>(c.slots.size());  // States are latest-wins; skip a tick
+        } else {
+            c.out.reserve(c.out.size() + c.slots.size() * sizeof(proto::StateMsg));
+            for (uint32_t index : c.slots) {
+                const Slot& slot = slots_[index];
+                const GameSession& s = slot.session;
+                proto::StateMsg m;
+                m.session = idOf(index);
+                m.tick = tick;
+                m.ackSequence = slot.ackSequence;
+                m.x = static_cast<float>(s.player().x);
+                m.y = static_cast<float>(s.player().y);
+                m.angle = proto::encodeAngle(s.player().angle);
+                m.flags = (s.hasKey() ? proto::HasKey : 0) | (s.hasWon() ? proto::Won : 0) | (s.hasLost() ? proto::Lost : 0);
+                m.score = static_cast<uint16_t>(s.score());
+                m.timeLeftMs = static_cast<uint32_t>(s.timeLeft() * 1000.0);
+                m.elapsedMs = static_cast<uint32_t>(s.elapsed() * 1000.0);
+                append(c.out, m);
+            }
+        }
+        if (!flush(c)) drop(client);
+    }
+}
+
+void SessionServer::run(double hz, double reportSeconds) {
+    const double tickSeconds = 1.0 / hz;
+    const auto period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(tickSeconds));
+    const auto reportPeriod = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(reportSeconds));
+    std::printf("Listening on %s, %.0f Hz, %d threads\n", path_.c_str(), hz, pool_.concurrency());
+    std::fflush(stdout);
+
+    TickStats stats;
+    stats.start();
+    auto deadline = Clock::now();
+    auto nextReport = deadline + reportPeriod;
+    uint32_t tick = 0;
+    while (gRunning) {
+        std::this_thread::sleep_until(deadline);
+        const auto begin = Clock::now();
+
+        // 1. Network in: new clients, then every message that has arrived.
+        pollFds_.clear();
+        pollFds_.push_back(pollfd{listenFd_, POLLIN, 0});
+        for (const Client& c : clients_) pollFds_.push_back(pollfd{c.fd, static_cast<short>(c.fd >= 0 ? POLLIN : 0), 0});
+        if (poll(pollFds_.data(), pollFds_.size(), 0) > 0) {
+            for (size_t i = 1; i < pollFds_.size(); ++i) {
+                const int client = static_cast<int>(i - 1);
+                if (clients_[client].fd >= 0 && (pollFds_[i].revents & (POLLIN | POLLHUP | POLLERR)) && !readClient(client))
+                    drop(client);
+            }
+            if (pollFds_[0].revents & POLLIN) acceptClients();
+        }
+
+        // 2. Step every live session; they share nothing but the read-only map.
+        pool_.parallelFor(static_cast<int>(slots_.size()), kStepGrain, [&](int first, int end) {
+            for (int i = first; i < end; ++i)
+                if (slots_[i].client >= 0) slots_[i].session.tick(slots_[i].input, tickSeconds);
+        });
+
+        // 3. Network out: each client gets the state of its sessions.
+        sendStates(++tick);
+
+        stats.add(millisecondsSince(begin), liveSessions_);
+        deadline += period;
+        const auto now = Clock::now();
+        if (now > deadline) {  // Overran: start the next tick at once, without catching up the missed ones
+            stats.late();
+            deadline = now;
+        }
+        if (now >= nextReport) {
+            stats.print("serve", hz, liveSessions_, liveClients_);
+            if (rejected_ || dropped_)
+                std::printf("  %lld inputs rejected, %lld states dropped for slow clients\n", rejected_, dropped_);
+            stats.start();
+            nextReport = now + reportPeriod;
+        }
+    }
+    stats.print("serve", hz, liveSessions_, liveClients_);
+}
+
+// Scripted sessions stepped back to back: the simulation's cost without sockets.
+int runBench(const Map& map, int sessions, double seconds, double hz, int threads) {
+    std::vector<GameSession> all(static_cast<size_t>(sessions), GameSession(map));
+    std::vector<SessionInput> inputs(all.size());
+    std::vector<Rng> rngs(all.size());
+    for (size_t i = 0; i < rngs.size(); ++i) rngs[i].state = static_cast<unsigned>(i * 2654435761u) | 1u;
+    ThreadPool pool(std::max(threads, 1) - 1);
+
+    TickStats stats;
+    stats.start();
+    const double tickSeconds = 1.0 / hz;
+    const auto end = Clock::now() + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
+    for (uint32_t tick = 0; Clock::now() < end && gRunning; ++tick) {
+        const auto begin = Clock::now();
+        pool.parallelFor(sessions, kStepGrain, [&](int first, int last) {
+            for (int i = first; i < last; ++i) {
+                // Wander: new buttons every half second or so; restart runs that ended.
+                SessionInput& input = inputs[i];
+                if (all[i].hasWon() || all[i].hasLost()) input.buttons = Button::Restart;
+                else if (input.buttons == Button::Restart || (tick + i) % 60 == 0) input.buttons = rngs[i].next() & 15;
+                all[i].tick(input, tickSeconds);
+            }
+        });
+        stats.add(millisecondsSince(begin), all.size());
+    }
+    stats.print("bench", hz, all.size(), 0);
+    return 0;
+}
+
+int usage(const char* argv0) {
+    std::fprintf(stderr,
+        "usage: %s [--socket PATH] [--level file.lvl] [--hz 120] [--threads N] [--max-sessions N] [--report S]\n"
+        "       %s --bench SESSIONS [--seconds S] [--hz 120] [--threads N] [--level file.lvl]\n",
+        argv0, argv0);
+    return 1;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::string socketPath = proto::kDefaultSocket;
+    const char* levelPath = nullptr;
+    double hz = GameSession::kTicksPerSecond;
+    double reportSeconds = 5.0;
+    double benchSeconds = 5.0;
+    int threads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    int benchSessions = 0;
+    size_t maxSessions = 100000;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc && argv[i + 1][0] != '-';
+        if (arg == "--socket" && hasValue) socketPath = argv[++i];
+        else if (arg == "--level" && hasValue) levelPath = argv[++i];
+        else if (arg == "--hz" && hasValue) hz = std::max(1.0, std::atof(argv[++i]));
+        else if (arg == "--threads" && hasValue) threads = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--max-sessions" && hasValue) maxSessions = std::strtoul(argv[++i], nullptr, 10);
+        else if (arg == "--report" && hasValue) reportSeconds = std::max(0.1, std::atof(argv[++i]));
+        else if (arg == "--bench" && hasValue) benchSessions = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--seconds" && hasValue) benchSeconds = std::atof(argv[++i]);
+        else return arg == "--help" ? (usage(argv[0]), 0) : usage(argv[0]);
+    }
+
+    Map map;
+    if (levelPath && !map.load(levelPath)) return 1;
+    std::signal(SIGINT, onSignal);
+    std::signal(SIGTERM, onSignal);
+    if (benchSessions) return runBench(map, benchSessions, benchSeconds, hz, threads);
+
+    SessionServer server(map, threads, maxSessions);
+    if (!server.listen(socketPath)) return 1;
+    server.run(hz, reportSeconds);
+    return 0;
+}
@@ -1,82 +1,110 @@
 #version 330 core
-in vec2 vUV;
-out vec4 fragColor;
-
+// Pass 1: one DDA per screen column into a columns x 1 target (see renderer_gl.cpp).
+layout(location = 0) out vec4 hit;
+layout(location = 1) out vec4 column;
 uniform vec2 uPlayerPos;
-uniform float uPlayerAngle;
-uniform float uFov;
-uniform vec2 uMapSize;
+uniform vec2 uCamDir;
+uniform vec2 uCamPlane;
+uniform float uColumns;
+uniform float uMaxDepth;
 uniform float uHasKey;
-uniform vec2 uResolution;
-
+uniform float uUseField;
+uniform float uFocal;
 uniform sampler2D uMapTex;
-
-const float MAX_DEPTH = 20.0;
+uniform sampler2D uFieldTex;
 const float FOG_DIST = 12.0;
-
-// Cell types
-const float C_EMPTY = 0.0;
 const float C_WALL  = 1.0;
 const float C_DOOR  = 2.0;
 const float C_KEY   = 3.0;
 const float C_EXIT  = 4.0;
-
-float sampleMap(vec2 p) {
-    vec2 uv = vec2((p.x + 0.5) / uMapSize.x, 1.0 - (p.y + 0.5) / uMapSize.y);
-    return texture(uMapTex, uv).r * 255.0;
+ivec2 mapSize;
+ivec2 stepDir;
+vec2 delta;
+bvec2 still;
+// Ray length to the far x / y boundary of column / row c.
+vec2 edgeDist(ivec2 c) {
+    vec2 toEdge = mix(uPlayerPos - vec2(c), vec2(c) + 1.0 - uPlayerPos, greaterThan(stepDir, ivec2(0)));
+    return mix(toEdge * delta, vec2(1e30), still);
+}
+float cellAt(ivec2 c) {
+    if (any(lessThan(c, ivec2(0))) || any(greaterThanEqual(c, mapSize))) return C_WALL;
+    return texelFetch(uMapTex, c, 0).r * 255.0;
+}
+bool stopsRay(float cellType) {
+    return cellType > 0.5 && !(uHasKey > 0.5 && abs(cellType - C_DOOR) < 0.5);
 }
-
 void main() {
-    float aspect = uResolution.x / uResolution.y;
-    float halfFov = uFov * 0.5;
-    float rayAngle = uPlayerAngle - halfFov + (vUV.x * uFov);
-    vec2 dir = vec2(cos(rayAngle), sin(rayAngle));
-
-    // DDA raymarch
-    float dist = 0.0;
-    float cellType = C_EMPTY;
-    vec2 hitCell = vec2(-1.0);
-    float stepSize = 0.04;
-
-    for (int i = 0; i < 400; i++) {
-        dist += stepSize;
-        vec2 pos = uPlayerPos + dir * dist;
-        vec2 cell = floor(pos);
-        cellType = sampleMap(cell);
-
-        if (cellType >= C_WALL) {
-            hitCell = cell;
+    mapSize = textureSize(uMapTex, 0);
+    float cameraX = 2.0 * floor(gl_FragCoord.x) / uColumns - 1.0;
+    vec2 dir = uCamDir + uCamPlane * cameraX;
+    ivec2 cell = ivec2(floor(uPlayerPos));
+    stepDir = ivec2(dir.x < 0.0 ? -1 : 1, dir.y < 0.0 ? -1 : 1);
+    still = equal(dir, vec2(0.0));
+    delta = abs(1.0 / mix(dir, vec2(1.0), still));
+    vec2 sideDist = edgeDist(cell);
+    float dist = uMaxDepth;
+    float cellType = 0.0;
+    float side = 0.0;
+    for (int i = 0; i < 256; i++) {
+        float d;
+        float s;
+        int r = 0;
+        if (uUseField > 0.5 && all(greaterThanEqual(cell, ivec2(0))) && all(lessThan(cell, mapSize)))
+            r = int(texelFetch(uFieldTex, cell, 0).r * 255.0 + 0.5) - 1;
+        if (r >= 1) {
+            // Leave the open square around the cell in one jump (see Raycaster::castRayField).
+            vec2 exitDist = edgeDist(cell + stepDir * r);
+            if (exitDist.x < exitDist.y) {
+                d = exitDist.x;
+                cell.y = clamp(int(floor(uPlayerPos.y + dir.y * d)), cell.y - r, cell.y + r);
+                cell.x += stepDir.x * (r + 1);
+                s = 0.0;
+            } else {
+                d = exitDist.y;
+                cell.x = clamp(int(floor(uPlayerPos.x + dir.x * d)), cell.x - r, cell.x + r);
+                cell.y += stepDir.y * (r + 1);
+                s = 1.0;
+            }
+            sideDist = edgeDist(cell);
+        } else if (sideDist.x < sideDist.y) {
+            d = sideDist.x;
+            sideDist.x += delta.x;
+            cell.x += stepDir.x;
+            s = 0.0;
+        } else {
+            d = sideDist.y;
+            sideDist.y += delta.y;
+            cell.y += stepDir.y;
+            s = 1.0;
+        }
+        if (d >= uMaxDepth) break;
+        float c = cellAt(cell);
+        if (stopsRay(c)) {
+            dist = d;
+            cellType = c;
+            side = s;
             break;
         }
     }
+    float along = side < 0.5 ? uPlayerPos.y + dist * dir.y : uPlayerPos.x + dist * dir.x;
+    float u = fract(along);
+    if ((side < 0.5 && dir.x > 0.0) || (side > 0.5 && dir.y < 0.0)) u = 1.0 - u;
+    hit = vec4(dist, cellType, side, u);
 
-    // Sky (ceiling) and floor by screen y
-    if (cellType < C_WALL) {
-        vec3 sky = vec3(0.15, 0.2, 0.35);
-        vec3 floorCol = vec3(0.12, 0.1, 0.08);
-        vec3 col = mix(floorCol, sky, vUV.y);
-        float fog = 1.0 - exp(-dist / FOG_DIST);
-        col = mix(col, vec3(0.4, 0.45, 0.5), fog * 0.6);
-        fragColor = vec4(col, 1.0);
-        return;
-    }
-
-    // Wall color by cell type
+    // Everything the shading pass needs per column: lit wall color and half its height in pixels.
     vec3 wallCol;
     if (cellType >= C_EXIT - 0.5)
         wallCol = vec3(0.2, 0.6, 0.25);
     else if (cellType >= C_KEY - 0.5)
         wallCol = vec3(0.85, 0.7, 0.2);
     else if (cellType >= C_DOOR - 0.5)
-        wallCol = uHasKey > 0.5 ? vec3(0.25, 0.2, 0.15) : vec3(0.35, 0.25, 0.15);
+        wallCol = vec3(0.35, 0.25, 0.15);
     else
         wallCol = vec3(0.4, 0.35, 0.3);
-
-    float shade = 1.0 - (dist / MAX_DEPTH) * 0.5;
+    float shade = 1.0 - (dist / uMaxDepth) * 0.5;
+    if (side > 0.5) shade *= 0.8;
     wallCol *= shade;
-
     float fog = 1.0 - exp(-dist / FOG_DIST);
     wallCol = mix(wallCol, vec3(0.35, 0.38, 0.4), fog);
-
-    fragColor = vec4(wallCol, 1.0);
+    column = vec4(wallCol, cellType > 0.5 ? 0.5 * uFocal / max(dist, 1e-4) : -1.0);
 }
@@ -0,0 +1,18 @@
+#version 330 core
+// Pass 2: full screen, reads the per-column result of raycaster.frag.
+in vec2 vUV;
+out vec4 fragColor;
+uniform vec2 uResolution;
+uniform sampler2D uColumnTex;
+void main() {
+    int columns = textureSize(uColumnTex, 0).x;
+    int column = min(int(gl_FragCoord.x * float(columns) / uResolution.x), columns - 1);
+    vec4 wall = texelFetch(uColumnTex, ivec2(column, 0), 0);
+    if (abs(gl_FragCoord.y - 0.5 * uResolution.y) <= wall.a) {
+        fragColor = vec4(wall.rgb, 1.0);
+        return;
+    }
+    vec3 ceilingCol = vec3(70.0/255.0, 130.0/255.0, 180.0/255.0);
+    vec3 floorCol = vec3(50.0/255.0, 50.0/255.0, 50.0/255.0);
+    fragColor = vec4(mix(floorCol, ceilingCol, step(0.5, vUV.y)), 1.0);
+}
@@ -0,0 +1,122 @@
+/*
+ * Chessboard distance transform: the classic two-pass raster scan (forward with the four
+ * already-visited 8-neighbours, then backward with the other four) is exact for Chebyshev
+ * distance. Because values are capped, a cell only depends on cells within kMaxDistance,
+ * so any rectangle can be recomputed on its own from a window padded by that much; that
+ * gives both the parallel build (independent bands of rows) and the incremental update.
+ */
+#include "distance_field.h"
+#include "thread_pool.h"
+#include <algorithm>
+
+namespace {
+
+constexpr int kBandRows = 256;   // Rows per parallel build task
+constexpr int kDoorBlock = 64;   // Granularity of the areas recomputed when doors open
+
+bool stopsRay(int cell, bool hasKey) {
+    return cell != Cell::Empty && !(cell == Cell::Door && hasKey);
+}
+
+} // namespace
+
+void DistanceField::computeRect(const TileMap& tiles, const Rect& r, std::vector<uint8_t>& scratch) {
+    const int cap = kMaxDistance;
+    const int wx0 = std::max(r.x0 - cap, 0), wx1 = std::min(r.x1 + cap, width_);
+    const int wy0 = std::max(r.y0 - cap, 0), wy1 = std::min(r.y1 + cap, height_);
+    // Window plus a one-cell ring: 0 where the ring is outside the map (solid), cap where it
+    // is inside but beyond the window (unknown, and too far to matter for r).
+    const int w = wx1 - wx0 + 2, h = wy1 - wy0 + 2;
+    scratch.resize(static_cast<size_t>(w) * h);
+    const CellGrid g = tiles.grid(false);
+    for (int y = 0; y < h; ++y) {
+        uint8_t* row = &scratch[static_cast<size_t>(y) * w];
+        const int my = wy0 + y - 1;
+        for (int x = 0; x < w; ++x) {
+            const int mx = wx0 + x - 1;
+            if (!g.inside(mx, my)) row[x] = 0;
+            else if (x == 0 || y == 0 || x == w - 1 || y == h - 1) row[x] = cap;
+            else row[x] = stopsRay(g.cell(mx, my), hasKey_) ? 0 : cap;
+        }
+    }
+
+    for (int y = 1; y < h - 1; ++y) {
+        uint8_t* row = &scratch[static_cast<size_t>(y) * w];
+        const uint8_t* up = row - w;
+        for (int x = 1; x < w - 1; ++x) {
+            int d = std::min({row[x - 1], up[x - 1], up[x], up[x + 1]}) + 1;
+            if (d < row[x]) row[x] = static_cast<uint8_t>(d);
+        }
+    }
+    for (int y = h - 2; y >= 1; --y) {
+        uint8_t* row = &scratch[static_cast<size_t>(y) * w];
+        const uint8_t* down = row + w;
+        for (int x = w - 2; x >= 1; --x) {
+            int d = std::min({row[x + 1], down[x - 1], down[x], down[x + 1]}) + 1;
+            if (d < row[x]) row[x] = static_cast<uint8_t>(d);
+        }
+    }
+
+    for (int y = r.y0; y < r.y1; ++y)
+        std::copy_n(&scratch[static_cast<size_t>(y - wy0 + 1) * w + (r.x0 - wx0 + 1)], r.x1 - r.x0,
+                    &cells_[static_cast<size_t>(y) * width_ + r.x0]);
+}
+
+void DistanceField::build(const TileMap& tiles, bool hasKey, int threads) {
+    width_ = tiles.width();
+    height_ = tiles.height();
+    hasKey_ = hasKey;
+    cells_.assign(static_cast<size_t>(width_) * height_, 0);
+
+    const int bands = (height_ + kBandRows - 1) / kBandRows;
+    auto computeBands = [&](int begin, int end) {
+        std::vector<uint8_t> scratch;
+        for (int b = begin; b < end; ++b)
+            computeRect(tiles, Rect{0, b * kBandRows, width_, std::min((b + 1) * kBandRows, height_)}, scratch);
+    };
+    if (threads > 1 && bands > 1) {
+        ThreadPool pool(std::min(threads, bands) - 1);
+        pool.parallelFor(bands, 1, computeBands);
+    } else {
+        computeBands(0, bands);
+    }
+
+    // Doors are the cells whose blocking bit differs between the two key states.
+    doorBlocks_.clear();
+    const CellGrid locked = tiles.grid(false), open = tiles.grid(true);
+    const int blocksX = (width_ + kDoorBlock - 1) / kDoorBlock;
+    const int blocksY = (height_ + kDoorBlock - 1) / kDoorBlock;
+    std::vector<bool> marked(static_cast<size_t>(blocksX) * blocksY, false);
+    const int tilesY = (height_ + TileMap::kTileSize - 1) / TileMap::kTileSize;
+    for (int ty = 0; ty < tilesY; ++ty)
+        for (int tx = 0; tx < locked.tilesX; ++tx) {
+            const int t = ty * locked.tilesX + tx;
+            if (!(locked.blocking[t] ^ open.blocking[t])) continue;
+            const int bx = tx * TileMap::kTileSize / kDoorBlock, by = ty * TileMap::kTileSize / kDoorBlock;
+            if (marked[static_cast<size_t>(by) * blocksX + bx]) continue;
+            marked[static_cast<size_t>(by) * blocksX + bx] = true;
+            // Every distance a door in this block can influence lies within kMaxDistance of it.
+            doorBlocks_.push_back(Rect{std::max(bx * kDoorBlock - kMaxDistance, 0),
+                                       std::max(by * kDoorBlock - kMaxDistance, 0),
+                                       std::min((bx + 1) * kDoorBlock + kMaxDistance, width_),
+                                       std::min((by + 1) * kDoorBlock + kMaxDistance, height_)});
+        }
+
+    ++revision_;
+    changed_ = Rect{0, 0, width_, height_};
+}
+
+void DistanceField::setKeyState(const TileMap& tiles, bool hasKey) {
+    if (hasKey == hasKey_) return;
+    hasKey_ = hasKey;
+    if (empty()) return;  // build() will use the new state
+    std::vector<uint8_t> scratch;
+    Rect bounds{width_, height_, 0, 0};
+    for (const Rect& r : doorBlocks_) {
+        computeRect(tiles, r, scratch);
+        bounds = Rect{std::min(bounds.x0, r.x0), std::min(bounds.y0, r.y0),
+                      std::max(bounds.x1, r.x1), std::max(bounds.y1, r.y1)};
+    }
+    ++revision_;
+    changed_ = doorBlocks_.empty() ? Rect{} : bounds;
+}
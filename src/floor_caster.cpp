@@ -0,0 +1,125 @@
+/*
+ * Floor / ceiling casting. A wall at perpendicular distance d spans H / d rows either side
+ * of the horizon (Raycaster::wallHeight), so the floor row whose center lies p rows below
+ * the horizon is at distance H / p. Row pairs (floor row and its mirrored ceiling row) are
+ * independent, which makes bands of them the unit of parallel work.
+ */
+#include "floor_caster.h"
+#include "raycaster_simd.h"
+#include "framebuffer.h"
+#include "thread_pool.h"
+#include "wall_textures.h"
+#include <cmath>
+
+#ifdef RAYCASTER_X86_SIMD
+#include <immintrin.h>
+#ifdef _MSC_VER
+#define RAYCASTER_TARGET_AVX2
+#else
+#define RAYCASTER_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace {
+
+constexpr int kBandPairs = 8;  // Row pairs per work item
+constexpr uint32_t kMask = WallTextures::kSize - 1;
+
+// One floor row and its mirrored ceiling row. u/v are texel coordinates (16.16) of the
+// first pixel and du/dv their step per pixel; both rows sample the same coordinates.
+struct RowPair {
+    uint32_t* floorRow;
+    uint32_t* ceilingRow;
+    int floorY, ceilingY;
+    uint32_t u, v, du, dv;
+    const uint32_t* colormap;
+};
+
+void castPixels(const RowPair& r, int begin, int end, const int* wallTop, const int* wallBottom,
+                const uint8_t* floorTex, const uint8_t* ceilingTex) {
+    uint32_t u = r.u + static_cast<uint32_t>(begin) * r.du, v = r.v + static_cast<uint32_t>(begin) * r.dv;
+    for (int x = begin; x < end; ++x, u += r.du, v += r.dv) {
+        const uint32_t texel = (((u >> 16) & kMask) << WallTextures::kSizeLog2) | ((v >> 16) & kMask);
+        if (r.floorY > wallBottom[x]) r.floorRow[x] = r.colormap[floorTex[texel]];
+        if (r.ceilingY < wallTop[x]) r.ceilingRow[x] = r.colormap[ceilingTex[texel]];
+    }
+}
+
+#ifdef RAYCASTER_X86_SIMD
+// 8 pixels per step: texel index in vector registers, two gathers per row (texel byte,
+// then colormap entry), masked stores so wall pixels are left alone. Returns the first
+// column not done.
+RAYCASTER_TARGET_AVX2
+int castPixelsAvx2(const RowPair& r, int width, const int* wallTop, const int* wallBottom,
+                   const uint8_t* floorTex, const uint8_t* ceilingTex) {
+    const __m256i lane = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    __m256i u = _mm256_add_epi32(_mm256_set1_epi32(static_cast<int>(r.u)),
+                                 _mm256_mullo_epi32(lane, _mm256_set1_epi32(static_cast<int>(r.du))));
+    __m256i v = _mm256_add_epi32(_mm256_set1_epi32(static_cast<int>(r.v)),
+                                 _mm256_mullo_epi32(lane, _mm256_set1_epi32(static_cast<int>(r.dv))));
+    const __m256i du8 = _mm256_set1_epi32(static_cast<int>(r.du * 8)), dv8 = _mm256_set1_epi32(static_cast<int>(r.dv * 8));
+    const __m256i mask = _mm256_set1_epi32(static_cast<int>(kMask)), byteMask = _mm256_set1_epi32(0xFF);
+    const __m256i floorY = _mm256_set1_epi32(r.floorY), ceilingY = _mm256_set1_epi32(r.ceilingY);
+    const int* colormap = reinterpret_cast<const int*>(r.colormap);
+
+    int x = 0;
+    for (; x + 8 <= width; x += 8) {
+        const __m256i floorMask = _mm256_cmpgt_epi32(floorY, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(wallBottom + x)));
+        const __m256i ceilingMask = _mm256_cmpgt_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(wallTop + x)), ceilingY);
+        const __m256i texel = _mm256_or_si256(
+            _mm256_slli_epi32(_mm256_and_si256(_mm256_srli_epi32(u, 16), mask), WallTextures::kSizeLog2),
+            _mm256_and_si256(_mm256_srli_epi32(v, 16), mask));
+        u = _mm256_add_epi32(u, du8);
+        v = _mm256_add_epi32(v, dv8);
+        // The atlas is padded, so the 32-bit texel gathers never read past it.
+        if (!_mm256_testz_si256(floorMask, floorMask)) {
+            const __m256i index = _mm256_and_si256(_mm256_i32gather_epi32(reinterpret_cast<const int*>(floorTex), texel, 1), byteMask);
+            _mm256_maskstore_epi32(reinterpret_cast<int*>(r.floorRow + x), floorMask, _mm256_i32gather_epi32(colormap, index, 4));
+        }
+        if (!_mm256_testz_si256(ceilingMask, ceilingMask)) {
+            const __m256i index = _mm256_and_si256(_mm256_i32gather_epi32(reinterpret_cast<const int*>(ceilingTex), texel, 1), byteMask);
+            _mm256_maskstore_epi32(reinterpret_cast<int*>(r.ceilingRow + x), ceilingMask, _mm256_i32gather_epi32(colormap, index, 4));
+        }
+    }
+    return x;
+}
+#endif
+
+} // namespace
+
+void castFloorAndCeiling(Framebuffer& fb, const Raycaster::Camera& cam, const WallTextures& textures,
+                         const int* wallTop, const int* wallBottom, SimdIsa isa, ThreadPool* pool) {
+    const int width = fb.width(), height = fb.height();
+    const uint8_t* floorTex = textures.floorTexture();
+    const uint8_t* ceilingTex = textures.ceilingTexture();
+    const double texelScale = WallTextures::kSize * 65536.0;
+    // Texel coordinates as 16.16 fixed point, wrapped to 32 bits (only the low bits are sampled).
+    auto fixed = [&](double world) { return static_cast<uint32_t>(static_cast<int64_t>(std::floor(world * texelScale))); };
+
+    auto castPairs = [&](int begin, int end) {
+        for (int i = begin; i < end; ++i) {
+            RowPair r;
+            r.ceilingY = height / 2 - 1 - i;
+            r.floorY = height - 1 - r.ceilingY;
+            const double distance = height / (r.floorY + 0.5 - height * 0.5);
+            r.floorRow = fb.row(r.floorY);
+            r.ceilingRow = fb.row(r.ceilingY);
+            r.u = fixed(cam.originX + distance * (cam.dirX - cam.planeX));
+            r.v = fixed(cam.originY + distance * (cam.dirY - cam.planeY));
+            r.du = fixed(distance * 2.0 * cam.planeX / width);
+            r.dv = fixed(distance * 2.0 * cam.planeY / width);
+            r.colormap = textures.colormap(static_cast<float>(distance), 0);
+            int x = 0;
+#ifdef RAYCASTER_X86_SIMD
+            if (isa == SimdIsa::Avx2) x = castPixelsAvx2(r, width, wallTop, wallBottom, floorTex, ceilingTex);
+#else
+            (void)isa;
+#endif
+            castPixels(r, x, width, wallTop, wallBottom, floorTex, ceilingTex);
+        }
+    };
+
+    const int pairs = height / 2;
+    if (pool) pool->parallelFor(pairs, kBandPairs, castPairs);
+    else castPairs(0, pairs);
+}
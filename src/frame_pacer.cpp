@@ -0,0 +1,67 @@
+#include "frame_pacer.h"
+#include <SDL2/SDL.h>
+#include <algorithm>
+#include <cmath>
+
+bool parseFramePacing(const std::string& name, FramePacing& pacing) {
+    if (name == "vsync") pacing = FramePacing::VSync;
+    else if (name == "adaptive") pacing = FramePacing::AdaptiveVSync;
+    else if (name == "uncapped") pacing = FramePacing::Uncapped;
+    else if (name == "limit") pacing = FramePacing::Limited;
+    else return false;
+    return true;
+}
+
+const char* framePacingName(FramePacing pacing) {
+    switch (pacing) {
+        case FramePacing::VSync: return "vsync";
+        case FramePacing::AdaptiveVSync: return "adaptive";
+        case FramePacing::Uncapped: return "uncapped";
+        case FramePacing::Limited: return "limit";
+    }
+    return "?";
+}
+
+void FramePacer::start(FramePacing pacing, double limitHz) {
+    pacing_ = pacing;
+    frequency_ = static_cast<double>(SDL_GetPerformanceFrequency());
+    period_ = static_cast<uint64_t>(frequency_ / std::max(limitHz, 1.0));
+    last_ = SDL_GetPerformanceCounter();
+    deadline_ = last_ + period_;
+    count_ = 0;
+}
+
+double FramePacer::endFrame() {
+    uint64_t now = SDL_GetPerformanceCounter();
+    if (pacing_ == FramePacing::Limited) {
+        if (now < deadline_) {
+            const double remainingMs = (deadline_ - now) * 1000.0 / frequency_;
+            if (remainingMs > kSpinMs) SDL_Delay(static_cast<Uint32>(remainingMs - kSpinMs));
+            while ((now = SDL_GetPerformanceCounter()) < deadline_) {}
+            deadline_ += period_;
+        } else {
+            deadline_ = now + period_;  // Missed it: start over instead of rushing to catch up
+        }
+    }
+    const double seconds = (now - last_) / frequency_;
+    last_ = now;
+    history_[count_++ % kHistory] = static_cast<float>(seconds * 1000.0);
+    return seconds;
+}
+
+double FramePacer::frameMs() const {
+    const int n = std::min(count_, kHistory);
+    if (n == 0) return 0.0;
+    double sum = 0.0;
+    for (int i = 0; i < n; ++i) sum += history_[i];
+    return sum / n;
+}
+
+double FramePacer::jitterMs() const {
+    const int n = std::min(count_, kHistory);
+    if (n < 2) return 0.0;
+    const double mean = frameMs();
+    double sq = 0.0;
+    for (int i = 0; i < n; ++i) sq += (history_[i] - mean) * (history_[i] - mean);
+    return std::sqrt(sq / n);
+}
@@ -0,0 +1,127 @@
+/*
+ * Software framebuffer: clipped fills, outlines, alpha blits, the nearest-texel stretch of a
+ * scaled frame, and the textured wall columns used by the CPU renderer.
+ */
+#include "framebuffer.h"
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+
+void Framebuffer::AlignedFree::operator()(uint32_t* p) const {
+    ::operator delete(p, std::align_val_t(64));
+}
+
+void Framebuffer::allocate(int width, int height) {
+    // Round the pitch up to a whole cache line so every row starts 64-byte aligned.
+    const int pitch = (width + 15) & ~15;
+    storage_.reset(static_cast<uint32_t*>(
+        ::operator new(sizeof(uint32_t) * static_cast<size_t>(pitch) * height, std::align_val_t(64))));
+    pixels_ = storage_.get();
+    width_ = width;
+    height_ = height;
+    pitch_ = pitch;
+}
+
+void Framebuffer::attach(uint32_t* pixels, int width, int height, int pitchBytes) {
+    storage_.reset();
+    pixels_ = pixels;
+    width_ = width;
+    height_ = height;
+    pitch_ = pitchBytes / static_cast<int>(sizeof(uint32_t));
+}
+
+void Framebuffer::clear(uint32_t color) {
+    for (int y = 0; y < height_; ++y) std::fill_n(row(y), width_, color);
+}
+
+void Framebuffer::fillRect(int x, int y, int w, int h, uint32_t color) {
+    const int x0 = std::max(x, 0), x1 = std::min(x + w, width_);
+    const int y0 = std::max(y, 0), y1 = std::min(y + h, height_);
+    if (x0 >= x1) return;
+    for (int py = y0; py < y1; ++py) std::fill(row(py) + x0, row(py) + x1, color);
+}
+
+void Framebuffer::drawRect(int x, int y, int w, int h, uint32_t color) {
+    fillRect(x, y, w, 1, color);
+    fillRect(x, y + h - 1, w, 1, color);
+    fillRect(x, y, 1, h, color);
+    fillRect(x + w - 1, y, 1, h, color);
+}
+
+void Framebuffer::drawLine(int x0, int y0, int x1, int y1, uint32_t color) {
+    // Bresenham, clipped per pixel (lines here are short).
+    const int dx = std::abs(x1 - x0), sx = x0 < x1 ? 1 : -1;
+    const int dy = -std::abs(y1 - y0), sy = y0 < y1 ? 1 : -1;
+    for (int err = dx + dy;;) {
+        if (x0 >= 0 && x0 < width_ && y0 >= 0 && y0 < height_) row(y0)[x0] = color;
+        if (x0 == x1 && y0 == y1) return;
+        const int e2 = 2 * err;
+        if (e2 >= dy) { err += dy; x0 += sx; }
+        if (e2 <= dx) { err += dx; y0 += sy; }
+    }
+}
+
+void Framebuffer::copyImage(const uint32_t* src, int srcPitchPixels, int w, int h, int x, int y) {
+    const int x0 = std::max(x, 0), x1 = std::min(x + w, width_);
+    const int y0 = std::max(y, 0), y1 = std::min(y + h, height_);
+    if (x0 >= x1) return;
+    for (int py = y0; py < y1; ++py) {
+        const uint32_t* s = src + static_cast<ptrdiff_t>(py - y) * srcPitchPixels + (x0 - x);
+        std::copy(s, s + (x1 - x0), row(py) + x0);
+    }
+}
+
+void Framebuffer::blendImage(const uint32_t* src, int srcPitchPixels, int w, int h, int x, int y) {
+    const int x0 = std::max(x, 0), x1 = std::min(x + w, width_);
+    const int y0 = std::max(y, 0), y1 = std::min(y + h, height_);
+    for (int py = y0; py < y1; ++py) {
+        const uint32_t* s = src + static_cast<ptrdiff_t>(py - y) * srcPitchPixels + (x0 - x);
+        uint32_t* d = row(py) + x0;
+        for (int px = x0; px < x1; ++px, ++s, ++d) {
+            const uint32_t a = *s >> 24;
+            if (a == 0) continue;
+            if (a == 255) { *d = *s | 0xFF000000u; continue; }
+            const uint32_t ia = 255 - a;
+            const uint32_t r = (((*s >> 16) & 0xFF) * a + ((*d >> 16) & 0xFF) * ia) / 255;
+            const uint32_t g = (((*s >> 8) & 0xFF) * a + ((*d >> 8) & 0xFF) * ia) / 255;
+            const uint32_t b = ((*s & 0xFF) * a + (*d & 0xFF) * ia) / 255;
+            *d = 0xFF000000u | (r << 16) | (g << 8) | b;
+        }
+    }
+}
+
+void Framebuffer::stretchImage(const uint32_t* src, int srcPitchPixels, int w, int h, int rowBegin, int rowEnd) {
+    rowBegin = std::max(rowBegin, 0);
+    rowEnd = std::min(rowEnd, height_);
+    if (w <= 0 || h <= 0 || width_ <= 0) return;
+    // 16.16 source column per pixel, starting at the texel under the first pixel's center.
+    const uint32_t uStep = static_cast<uint32_t>((static_cast<uint64_t>(w) << 16) / width_);
+    const uint32_t u0 = uStep / 2;
+    int previous = -1;
+    for (int y = rowBegin; y < rowEnd; ++y) {
+        const int sy = static_cast<int>((2 * static_cast<int64_t>(y) + 1) * h / (2 * static_cast<int64_t>(height_)));
+        uint32_t* d = row(y);
+        if (sy == previous) {  // Upscaled rows repeat; copy the one just written
+            std::copy(row(y - 1), row(y - 1) + width_, d);
+            continue;
+        }
+        const uint32_t* s = src + static_cast<ptrdiff_t>(sy) * srcPitchPixels;
+        uint32_t u = u0;
+        for (int x = 0; x < width_; ++x, u += uStep) d[x] = s[u >> 16];
+        previous = sy;
+    }
+}
+
+void Framebuffer::drawTexturedColumn(int x, int top, int bottom, const uint8_t* texels, uint32_t texelMask,
+                                     uint32_t v0, uint32_t vStep, const uint32_t* colormap) {
+    if (x < 0 || x >= width_) return;
+    if (top < 0) {
+        v0 += static_cast<uint32_t>(-top) * vStep;
+        top = 0;
+    }
+    bottom = std::min(bottom, height_ - 1);
+    if (top > bottom) return;
+    const ptrdiff_t pitch = pitch_;
+    uint32_t* p = row(top) + x;
+    for (uint32_t v = v0; top <= bottom; ++top, p += pitch, v += vStep) *p = colormap[texels[(v >> 16) & texelMask]];
+}
@@ -0,0 +1,66 @@
+#include "game_session.h"
+#include "map.h"
+#include <algorithm>
+#include <cmath>
+
+void GameSession::reset() {
+    const LevelInfo& info = map_->info();
+    player_.x = info.spawnX;
+    player_.y = info.spawnY;
+    player_.angle = info.spawnAngle;
+    timer_ = kTimeLimit;
+    elapsed_ = 0.0;
+    score_ = 0;
+    hasKey_ = false;
+    hasWon_ = false;
+    hasLost_ = false;
+}
+
+uint8_t GameSession::tick(const SessionInput& input, double seconds) {
+    uint8_t events = 0;
+    // --- Timer (countdown) and elapsed time ---
+    if (!hasWon_ && !hasLost_) {
+        timer_ -= seconds;
+        elapsed_ += seconds;
+        if (timer_ <= 0.0) {
+            timer_ = 0.0;
+            hasLost_ = true;
+            events |= TimedOut;
+        }
+    }
+
+    // --- Movement: each held direction moves one axis; a step into a blocking cell is dropped ---
+    if (std::isfinite(input.angle)) player_.angle = std::remainder(input.angle, 6.283185307179586);
+    const double step = std::min(kMoveSpeed * seconds, 1.0);  // Never past a wall cell
+    const CellGrid solid = map_->tiles().grid(hasKey_);  // Blocking bitplane for the current key state
+    auto tryMove = [this, &solid](double nx, double ny) {
+        if (!solid(static_cast<int>(nx), static_cast<int>(ny))) {
+            player_.x = nx;
+            player_.y = ny;
+        }
+    };
+    if (!hasLost_ && !hasWon_) {
+        if (input.buttons & Button::North) tryMove(player_.x, player_.y - step);
+        if (input.buttons & Button::South) tryMove(player_.x, player_.y + step);
+        if (input.buttons & Button::West) tryMove(player_.x - step, player_.y);
+        if (input.buttons & Button::East) tryMove(player_.x + step, player_.y);
+    }
+    if (input.buttons & Button::Restart) {
+        reset();
+        events |= Restarted;
+    }
+
+    // --- Pickups: the key opens the doors, the exit (with the key) ends the run ---
+    if (hasWon_ || hasLost_) return events;
+    const int cell = map_->getCell(static_cast<int>(player_.x), static_cast<int>(player_.y));
+    if (cell == Cell::Key && !hasKey_) {
+        hasKey_ = true;
+        events |= KeyPickedUp;
+    }
+    if (cell == Cell::Exit && hasKey_) {
+        hasWon_ = true;
+        score_ = static_cast<int>(timer_);
+        events |= Escaped;
+    }
+    return events;
+}
@@ -38,9 +38,25 @@ void (*glBindTexture)(GLenum, GLuint) = nullptr;
 void (*glActiveTexture)(GLenum) = nullptr;
 void (*glTexParameteri)(GLenum, GLenum, GLint) = nullptr;
 void (*glTexImage2D)(GLenum, GLint, GLint, GLsizei, GLsizei, GLint, GLenum, GLenum, const void*) = nullptr;
+void (*glTexSubImage2D)(GLenum, GLint, GLint, GLint, GLsizei, GLsizei, GLenum, GLenum, const void*) = nullptr;
+void (*glPixelStorei)(GLenum, GLint) = nullptr;
 void (*glClear)(GLbitfield) = nullptr;
 void (*glClearColor)(GLfloat, GLfloat, GLfloat, GLfloat) = nullptr;
 void (*glViewport)(GLint, GLint, GLsizei, GLsizei) = nullptr;
+void (*glGetIntegerv)(GLenum, GLint*) = nullptr;
+void (*glGenFramebuffers)(GLsizei, GLuint*) = nullptr;
+void (*glDeleteFramebuffers)(GLsizei, const GLuint*) = nullptr;
+void (*glBindFramebuffer)(GLenum, GLuint) = nullptr;
+void (*glFramebufferTexture2D)(GLenum, GLenum, GLenum, GLuint, GLint) = nullptr;
+GLenum (*glCheckFramebufferStatus)(GLenum) = nullptr;
+void (*glDrawBuffers)(GLsizei, const GLenum*) = nullptr;
+void (*glBlitFramebuffer)(GLint, GLint, GLint, GLint, GLint, GLint, GLint, GLint, GLbitfield, GLenum) = nullptr;
+void (*glGenQueries)(GLsizei, GLuint*) = nullptr;
+void (*glDeleteQueries)(GLsizei, const GLuint*) = nullptr;
+void (*glBeginQuery)(GLenum, GLuint) = nullptr;
+void (*glEndQuery)(GLenum) = nullptr;
+void (*glGetQueryObjectiv)(GLuint, GLenum, GLint*) = nullptr;
+void (*glGetQueryObjectui64v)(GLuint, GLenum, GLuint64*) = nullptr;
 
 int gl_core_load(void) {
 #define L(n) do { *(void**)&n = glProc(#n); if (!(n)) return -1; } while(0)
@@ -78,9 +94,25 @@ int gl_core_load(void) {
     L(glActiveTexture);
     L(glTexParameteri);
     L(glTexImage2D);
+    L(glTexSubImage2D);
+    L(glPixelStorei);
     L(glClear);
     L(glClearColor);
     L(glViewport);
+    L(glGetIntegerv);
+    L(glGenFramebuffers);
+    L(glDeleteFramebuffers);
+    L(glBindFramebuffer);
+    L(glFramebufferTexture2D);
+    L(glCheckFramebufferStatus);
+    L(glDrawBuffers);
+    L(glBlitFramebuffer);
+    L(glGenQueries);
+    L(glDeleteQueries);
+    L(glBeginQuery);
+    L(glEndQuery);
+    L(glGetQueryObjectiv);
+    L(glGetQueryObjectui64v);
 #undef L
     return 0;
 }
@@ -2,80 +2,173 @@
  * FIND THE DOOR — First-person maze game with raycasting
  * ------------------------------------------------------
  * Main loop: input -> game logic -> render.
- * Maze: fixed 2D grid (map.h/map.cpp). Raycasting: GPU (GL) or CPU (raycaster.cpp).
+ * Maze: 2D grid (map.h/map.cpp), built in or loaded from a level file with --level. Raycasting: GPU (GL) or CPU (raycaster.cpp).
  * UI: timer (countdown), elapsed time, score on screen; minimap at bottom.
  */
 #define SDL_MAIN_HANDLED
 #include <iostream>
 #include <cmath>
+#include <cstdio>
+#include <cstdlib>
 #include <memory>
 #include <algorithm>
+#include <chrono>
 #include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
 #include <SDL2/SDL.h>
 #ifdef HAS_SDL2_TTF
 #include <SDL2/SDL_ttf.h>
 #endif
 
 #include "gl_core.h"
+#include "framebuffer.h"
 #include "player.h"
+#include "game_session.h"
 #include "map.h"
 #include "renderer_gl.h"
 #include "raycaster.h"
+#include "profiler.h"
+#include "frame_pacer.h"
+#include "wall_textures.h"
+#include "floor_caster.h"
+#include "sprite_renderer.h"
+#include "text_renderer.h"
+#include "minimap_cache.h"
+#include "navigation.h"
+#include "render_scale.h"
+#include "replay.h"
+#include "thread_pool.h"
 
 // Resolution: GL path high-res; CPU fallback lower for ~60 FPS.
 constexpr int SCREEN_WIDTH  = 2560;
 constexpr int SCREEN_HEIGHT = 1440;
 constexpr int CPU_WIDTH     = 1280;
 constexpr int CPU_HEIGHT    = 720;
-constexpr double TIMER_START = 120.0;   // Countdown seconds to reach exit
+constexpr double TICK_SECONDS = 1.0 / GameSession::kTicksPerSecond;  // Fixed simulation step
+constexpr double MAX_FRAME_SECONDS = 0.25;     // Longest frame the simulation catches up on
 constexpr double MOUSE_SENSITIVITY = 0.003;  // Radians per pixel for mouse look
+constexpr Uint32 IDLE_WAIT_MS = 50;     // On-demand: longest sleep in game (timer and hints still tick)
+constexpr Uint32 STATIC_WAIT_MS = 250;  // On-demand: longest sleep on the title and win screens
 
 class Game {
 public:
-    Game() : raycaster_(CPU_WIDTH, CPU_HEIGHT) {}
+    Game()
+        : raycaster_(CPU_WIDTH, CPU_HEIGHT, static_cast<int>(std::thread::hardware_concurrency())),
+          hits_(CPU_WIDTH), wallTextures_(raycaster_.maxDepth()), wallTop_(CPU_WIDTH), wallBottom_(CPU_WIDTH) {}
     ~Game();
 
+    bool loadLevel(const std::string& path);  // Replace the built-in maze; call before initialize()
     bool initialize();
     void run();
+    void setRenderThreads(int threads) { raycaster_.setThreadCount(threads); }  // CPU path only
+    void setFramePacing(FramePacing pacing, double limitHz) { pacing_ = pacing; frameLimitHz_ = limitHz; }
+    void setTraceFile(const std::string& path) { tracePath_ = path; traceAtExit_ = true; }
+    void setOnDemand(bool onDemand) { onDemand_ = onDemand; }
+    void setRecordFile(const std::string& path) { recordPath_ = path; }
+    bool loadReplay(const std::string& path);  // Play it instead of reading input; call after loadLevel()
+    void setReplayFast(bool fast) { replayFast_ = fast; }
+    // Fraction of the output resolution the 3D view is drawn at; 0 = adapt to the frame budget.
+    void setRenderScale(double scale) {
+        if (scale > 0.0) renderScale_.setFixed(scale);
+        else renderScale_.setAdaptive();
+    }
+    void setFrameBudget(double ms) { frameBudgetMs_ = ms; }  // 0 = one refresh (or --fps period)
 
 private:
-    void processInput(double deltaTime);
+    // Everything a rendered frame depends on. When it matches the last rendered frame, the
+    // on-demand loop leaves that frame on screen instead of drawing it again.
+    struct FrameState {
+        int screen = -1;  // 0 title, 1 playing, 2 won
+        float x = 0.0f, y = 0.0f, angle = 0.0f;
+        int elapsedSeconds = 0, leftSeconds = 0, score = 0;
+        bool hasKey = false, hasLost = false, startHint = false, keyHint = false;
+
+        auto tie() const {
+            return std::tie(screen, x, y, angle, elapsedSeconds, leftSeconds, score, hasKey, hasLost, startHint, keyHint);
+        }
+        bool operator==(const FrameState& o) const { return tie() == o.tie(); }
+    };
+    FrameState frameState() const;
+
+    void processInput();
+    void simulate(double deltaTime);
+    void reportReplay(double seconds) const;
     void render();
     void renderTitleScreen();
     void renderTitleScreenCPU();
     void renderGL();
     void renderCPU();
-    void renderMinimapCPU();
-    void checkPickups();
+    void renderHudCPU(Framebuffer& fb);
+    void renderMinimapCPU(Framebuffer& fb);
+    void renderCompassCPU(Framebuffer& fb);
+    Framebuffer* beginFrameCPU();
+    void presentFrameCPU();
+    void respawn();
     void updateTitle();
+    double defaultFrameBudgetMs() const;
+    void measureRenderWork(double ms);
 
     SDL_Window* window_   = nullptr;
     SDL_GLContext glContext_ = nullptr;
     SDL_Renderer* sdlRenderer_ = nullptr;
+    SDL_Texture* frameTexture_ = nullptr;  // Streaming ARGB8888 target for the CPU frame
 #ifdef HAS_SDL2_TTF
     TTF_Font* font_ = nullptr;
 #endif
+    Map map_;  // Declared before the renderers that hold a reference to it
+    GameSession session_{map_};  // Player, key, timer and score, and the rules that change them
     RendererGL rendererGL_;
     Raycaster raycaster_;
-
-    Player player_;
-    bool hasKey_ = false;
-    bool hasWon_ = false;
-    bool hasLost_ = false;
+    Framebuffer frame_;  // Attached to frameTexture_ while it is locked
+    Framebuffer sceneStorage_;  // CPU_WIDTH x CPU_HEIGHT; scene_ uses its top-left corner
+    Framebuffer scene_;         // 3D view below full render scale, stretched into frame_
+    RayHitBuffer hits_;  // Reused every frame by the CPU renderer
+    WallTextures wallTextures_;  // Shading tables are built for raycaster_'s max depth
+    std::vector<int> wallTop_;     // Rows drawn by the wall pass; the floor pass fills around them
+    std::vector<int> wallBottom_;
+    SpriteRenderer spriteRenderer_;
+    std::vector<Sprite> sprites_;  // Rebuilt every frame; keeps its capacity
+    TextRenderer text_;            // Glyph atlas and string cache for text on the CPU frame
+    MinimapCache minimap_{MINIMAP_CELL};  // Static cells; player, view cone and key drawn over it
+    Navigation navigation_;               // Flow fields to the key and exit; drives the objective arrow
+    Profiler profiler_;
+    std::string tracePath_ = "trace.json";  // F9 writes the profiler ring here
+    bool traceAtExit_ = false;
+
+    int mouseDx_ = 0;                           // Mouse motion since the last simulation tick
+    std::string recordPath_;                    // --record: every tick's input is saved here at exit
+    std::unique_ptr<ReplayWriter> recorder_;    // Created on the first tick of play
+    Replay replay_;                             // --replay: ticks take their input from here
+    std::unique_ptr<Replay::Cursor> playback_;  // Null unless replaying
+    bool replayFast_ = false;                   // One tick per frame instead of real time
+    long long replayFrames_ = 0;
+
+    Player previous_;  // session_'s player before the latest simulation tick
+    Player view_;      // Interpolated between previous_ and the session's player; what gets rendered
+    FramePacer pacer_;
+    FramePacing pacing_ = FramePacing::VSync;
+    double frameLimitHz_ = 144.0;
+    RenderScale renderScale_;    // Dynamic resolution of the 3D view
+    double frameBudgetMs_ = 0.0;  // Render time renderScale_ aims under; 0 until run() picks one
+    bool onDemand_ = false;     // Skip unchanged frames and sleep in SDL_WaitEventTimeout
+    bool redraw_ = true;        // The window needs repainting whatever the frame state
+    FrameState lastFrame_;      // State of the frame on screen
+    long long skippedFrames_ = 0;
     bool running_ = true;
     bool useCpuRenderer_ = false;
     bool showTitleScreen_ = true;
-    double timer_ = TIMER_START;
-    double elapsedTime_ = 0.0;  // Seconds since game start (for "time taken" on win)
-    int score_ = 0;
     Uint32 keyPickupDisplayUntil_ = 0;  // Show "KEY PICKED UP!" until this tick
     Uint32 startHintDisplayUntil_ = 0;  // Show "Find gold key..." for 4 sec at start
     static constexpr int MINIMAP_CELL = 8;
+    static constexpr int MINIMAP_SPAN = 24;  // Cells shown per side; larger levels scroll with the player
     static constexpr int MINIMAP_MARGIN = 8;
+    static constexpr int COMPASS_LOOKAHEAD = 4;  // Cells along the path the objective arrow aims at
 
-    void drawText(SDL_Renderer* r, const char* text, int x, int y, int fontSize, SDL_Color color, bool centerX);
-    void drawBlockText(SDL_Renderer* r, const char* text, int cx, int cy, int blockW, int blockH, int gap);
-    void drawBlockTextLeft(SDL_Renderer* r, const char* text, int x, int y, int blockW, int blockH, int gap);
+    void drawText(Framebuffer& fb, const char* text, int x, int y, int fontSize, SDL_Color color, bool centerX);
+    void drawBlockText(Framebuffer& fb, const char* text, int cx, int cy, int blockW, int blockH, int gap, uint32_t color);
+    void drawBlockTextLeft(Framebuffer& fb, const char* text, int x, int y, int blockW, int blockH, int gap, uint32_t color);
     std::string formatTime(double seconds) const;
     void renderWinScreenCPU();
     void renderWinScreenGL();
@@ -83,10 +176,12 @@ private:
 
 Game::~Game() {
 #ifdef HAS_SDL2_TTF
+    text_.setFont(nullptr);
     if (font_) { TTF_CloseFont(font_); font_ = nullptr; }
     if (useCpuRenderer_) TTF_Quit();
 #endif
     if (glContext_) SDL_GL_DeleteContext(glContext_);
+    if (frameTexture_) SDL_DestroyTexture(frameTexture_);
     if (sdlRenderer_) SDL_DestroyRenderer(sdlRenderer_);
     if (window_) SDL_DestroyWindow(window_);
     SDL_Quit();
@@ -97,6 +192,9 @@ bool Game::initialize() {
         std::cerr << "SDL_Init failed: " << SDL_GetError() << "\n";
         return false;
     }
+    // Both renderers skip empty space with it; the GL one uploads it in init().
+    map_.buildDistanceField(static_cast<int>(std::thread::hardware_concurrency()));
+    navigation_.build(map_, session_.hasKey());
 
     SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 3);
     SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 3);
@@ -120,7 +218,12 @@ bool Game::initialize() {
         goto use_cpu;
     }
 
-    SDL_GL_SetSwapInterval(1);
+    if (pacing_ == FramePacing::AdaptiveVSync && SDL_GL_SetSwapInterval(-1) != 0) {
+        std::cerr << "Adaptive vsync not supported; using vsync.\n";
+        pacing_ = FramePacing::VSync;
+    }
+    if (pacing_ != FramePacing::AdaptiveVSync)
+        SDL_GL_SetSwapInterval(pacing_ == FramePacing::VSync ? 1 : 0);
     if (gl_core_load() != 0) {
         std::cerr << "OpenGL function loader failed.\n";
         SDL_GL_DeleteContext(glContext_);
@@ -130,7 +233,7 @@ bool Game::initialize() {
         goto use_cpu;
     }
 
-    if (!rendererGL_.init(SCREEN_WIDTH, SCREEN_HEIGHT)) {
+    if (!rendererGL_.init(SCREEN_WIDTH, SCREEN_HEIGHT, map_)) {
         std::cerr << "OpenGL 3.3 not available; using CPU raycaster fallback (1280x720).\n";
         SDL_GL_DeleteContext(glContext_);
         SDL_DestroyWindow(window_);
@@ -156,6 +259,7 @@ use_cpu:
             font_ = TTF_OpenFont(path, 24);
             if (font_) break;
         }
+        text_.setFont(font_);
     }
 #endif
     window_ = SDL_CreateWindow(
@@ -170,199 +274,193 @@ use_cpu:
         std::cerr << "SDL_CreateWindow failed: " << SDL_GetError() << "\n";
         return false;
     }
-    sdlRenderer_ = SDL_CreateRenderer(window_, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
+    // SDL_Renderer has no adaptive mode; both vsync modes use plain vsync.
+    const bool vsync = pacing_ == FramePacing::VSync || pacing_ == FramePacing::AdaptiveVSync;
+    sdlRenderer_ = SDL_CreateRenderer(window_, -1, SDL_RENDERER_ACCELERATED | (vsync ? SDL_RENDERER_PRESENTVSYNC : 0));
     if (!sdlRenderer_) {
         std::cerr << "SDL_CreateRenderer failed: " << SDL_GetError() << "\n";
         return false;
     }
+    frameTexture_ = SDL_CreateTexture(sdlRenderer_, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING,
+                                      CPU_WIDTH, CPU_HEIGHT);
+    if (!frameTexture_) {
+        std::cerr << "SDL_CreateTexture failed: " << SDL_GetError() << "\n";
+        return false;
+    }
+    sceneStorage_.allocate(CPU_WIDTH, CPU_HEIGHT);
     SDL_SetWindowTitle(window_,
         "Find the GREEN door | Get key first, pass brown door | SPACE to start");
     return true;
 }
 
-void Game::checkPickups() {
-    if (hasWon_ || hasLost_) return;
-    int px = static_cast<int>(player_.x);
-    int py = static_cast<int>(player_.y);
-    int cell = Map::getCell(px, py);
-    if (cell == Cell::Key && !hasKey_) {
-        hasKey_ = true;
-        keyPickupDisplayUntil_ = SDL_GetTicks() + 2500;  // Show notification for 2.5 sec
-    }
-    if (cell == Cell::Exit && hasKey_) {
-        hasWon_ = true;
-        score_ = static_cast<int>(timer_);
+bool Game::loadLevel(const std::string& path) {
+    if (!map_.load(path)) return false;
+    minimap_.invalidate();
+    respawn();
+    return true;
+}
+
+bool Game::loadReplay(const std::string& path) {
+    if (!replay_.load(path)) return false;
+    const ReplayHeader& h = replay_.header();
+    if (h.levelHash != levelFingerprint(map_) || h.levelWidth != map_.width() || h.levelHeight != map_.height()) {
+        std::cerr << path << ": recorded on a different level (pass the same --level first)\n";
+        return false;
     }
+    playback_ = std::make_unique<Replay::Cursor>(replay_);
+    showTitleScreen_ = false;  // The recording starts at the first tick of play
+    return true;
+}
+
+void Game::respawn() {
+    session_.reset();
+    previous_ = session_.player();  // Don't interpolate across the teleport
 }
 
 void Game::updateTitle() {
     if (showTitleScreen_) return;
     std::string title = "Dungeon Run";
-    if (hasWon_) {
-        title += " — You escaped! Score: " + std::to_string(score_) + " | R=restart ESC=quit";
-    } else if (hasLost_) {
+    if (session_.hasWon()) {
+        title += " — You escaped! Score: " + std::to_string(session_.score()) + " | R=restart ESC=quit";
+    } else if (session_.hasLost()) {
         title += " — Time's up! Score: 0 | R=restart ESC=quit";
     } else {
-        int sec = static_cast<int>(timer_) % 60;
-        int min = static_cast<int>(timer_) / 60;
+        int sec = static_cast<int>(session_.timeLeft()) % 60;
+        int min = static_cast<int>(session_.timeLeft()) / 60;
         title += " — " + std::to_string(min) + ":" + (sec < 10 ? "0" : "") + std::to_string(sec);
-        if (hasKey_) title += " [KEY]";
+        if (session_.hasKey()) title += " [KEY]";
     }
+    char pacing[96];
+    std::snprintf(pacing, sizeof pacing, " | %.0f fps, jitter %.2f ms (%s)",
+                  1000.0 / std::max(pacer_.frameMs(), 0.001), pacer_.jitterMs(), framePacingName(pacing_));
+    title += pacing;
+    if (onDemand_) title += " | skipped " + std::to_string(skippedFrames_);
+    if (!useCpuRenderer_) {
+        char gpu[64];
+        std::snprintf(gpu, sizeof gpu, " | GPU cast %.2f ms, shade %.2f ms", rendererGL_.castGpuMs(), rendererGL_.shadeGpuMs());
+        title += gpu;
+    }
+    char scale[96];
+    if (renderScale_.adaptive())
+        std::snprintf(scale, sizeof scale, " | scale %.0f%% (auto, %.2f / %.2f ms)", renderScale_.scale() * 100.0,
+                      renderScale_.averageMs(), renderScale_.budgetMs());
+    else
+        std::snprintf(scale, sizeof scale, " | scale %.0f%%", renderScale_.scale() * 100.0);
+    title += scale;
     SDL_SetWindowTitle(window_, title.c_str());
 }
 
-void Game::processInput(double deltaTime) {
+double Game::defaultFrameBudgetMs() const {
+    if (pacing_ == FramePacing::Limited) return 1000.0 / std::max(frameLimitHz_, 1.0);
+    SDL_DisplayMode mode;
+    const int display = SDL_GetWindowDisplayIndex(window_);
+    if (pacing_ != FramePacing::Uncapped && display >= 0 && SDL_GetCurrentDisplayMode(display, &mode) == 0 &&
+        mode.refresh_rate > 0)
+        return 1000.0 / mode.refresh_rate;
+    return 1000.0 / 60.0;  // Uncapped, or the refresh rate is unknown
+}
+
+// Feeds the render scale controller one frame's render time (ms), measured at the current scale.
+void Game::measureRenderWork(double ms) {
+    profiler_.counter("render work ms", ms);
+    renderScale_.update(ms);
+    profiler_.counter("render scale", renderScale_.scale());
+}
+
+void Game::processInput() {
+    ProfileZone inputZone(profiler_, "input");
     SDL_Event event;
     while (SDL_PollEvent(&event)) {
         if (event.type == SDL_QUIT) running_ = false;
+        if (event.type == SDL_WINDOWEVENT) redraw_ = true;  // Exposed, resized, restored...
+        if (event.type == SDL_MOUSEMOTION && !showTitleScreen_ && !playback_) mouseDx_ += event.motion.xrel;
         if (!useCpuRenderer_ && event.type == SDL_WINDOWEVENT && event.window.event == SDL_WINDOWEVENT_RESIZED)
             rendererGL_.resize(event.window.data1, event.window.data2);
+        if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_F9 && !event.key.repeat &&
+            profiler_.writeChromeTrace(tracePath_))
+            std::cout << "Wrote frame trace to " << tracePath_ << "\n";
     }
 
     const Uint8* state = SDL_GetKeyboardState(nullptr);
     if (showTitleScreen_) {
         if (state[SDL_SCANCODE_SPACE]) {
             showTitleScreen_ = false;
-            elapsedTime_ = 0.0;
             startHintDisplayUntil_ = SDL_GetTicks() + 4000;  // Show hint for 4 sec
             SDL_SetRelativeMouseMode(SDL_TRUE);  // Mouse look
             updateTitle();
         }
         return;
     }
-
-    // --- Game mechanics: timer (countdown), elapsed time, score ---
-    if (!hasWon_ && !hasLost_) {
-        timer_ -= deltaTime;
-        elapsedTime_ += deltaTime;
-        if (timer_ <= 0.0) {
-            timer_ = 0.0;
-            hasLost_ = true;
-        }
-    }
-
-    // --- Player movement: map-aligned (W=up/north, S=down/south, A=left/west, D=right/east) ---
-    // Aligns to minimap directions for easier navigation; mouse = rotate view only
-    double moveSpeed = 3.0 * deltaTime;
-
-    auto tryMove = [this](double nx, double ny) {
-        int ix = static_cast<int>(nx);
-        int iy = static_cast<int>(ny);
-        if (!Map::isBlocking(ix, iy, hasKey_)) {
-            player_.x = nx;
-            player_.y = ny;
-        }
-    };
-
-    if (!hasLost_ && !hasWon_) {
-        if (state[SDL_SCANCODE_W]) tryMove(player_.x, player_.y - moveSpeed);      // north (up on map)
-        if (state[SDL_SCANCODE_S]) tryMove(player_.x, player_.y + moveSpeed);      // south (down on map)
-        if (state[SDL_SCANCODE_A]) tryMove(player_.x - moveSpeed, player_.y);      // west (left on map)
-        if (state[SDL_SCANCODE_D]) tryMove(player_.x + moveSpeed, player_.y);      // east (right on map)
-    }
     if (state[SDL_SCANCODE_ESCAPE]) {
         SDL_SetRelativeMouseMode(SDL_FALSE);
         running_ = false;
     }
-    if (state[SDL_SCANCODE_R]) {
-        // R = restart (reset game state)
-        player_.x = 1.5;
-        player_.y = 1.5;
-        timer_ = TIMER_START;
-        elapsedTime_ = 0.0;
-        hasKey_ = false;
-        hasWon_ = false;
-        hasLost_ = false;
+}
+
+// One fixed simulation tick: the session applies the held keys and mouse look (or the
+// replay's recording of them); the game reacts to what changed.
+void Game::simulate(double deltaTime) {
+    TickInput input;
+    double sensitivity = MOUSE_SENSITIVITY;
+    if (playback_) {
+        if (!playback_->next(input)) {
+            running_ = false;  // End of the recording (or a corrupt one)
+            return;
+        }
+        sensitivity = replay_.header().mouseSensitivity;
+    } else {
+        const Uint8* state = SDL_GetKeyboardState(nullptr);
+        // Map-aligned movement (W=up/north, S=down/south, A=left/west, D=right/east) matches the
+        // minimap; R restarts.
+        if (state[SDL_SCANCODE_W]) input.buttons |= Button::North;
+        if (state[SDL_SCANCODE_S]) input.buttons |= Button::South;
+        if (state[SDL_SCANCODE_A]) input.buttons |= Button::West;
+        if (state[SDL_SCANCODE_D]) input.buttons |= Button::East;
+        if (state[SDL_SCANCODE_R]) input.buttons |= Button::Restart;
+        input.mouseDx = mouseDx_;  // All motion since the last tick turns the view on this one
+        mouseDx_ = 0;
+    }
+    if (!recordPath_.empty()) {
+        if (!recorder_)
+            recorder_ = std::make_unique<ReplayWriter>(map_, GameSession::kTicksPerSecond, sensitivity);
+        recorder_->record(input);
     }
 
-    checkPickups();
-    updateTitle();
+    const uint8_t events = session_.tick(input.toSession(session_, sensitivity), deltaTime);
+    if (events & GameSession::Restarted) {
+        previous_ = session_.player();  // Don't interpolate across the teleport
+        map_.setKeyHeld(false);
+        navigation_.setKeyHeld(map_, false);
+    }
+    if (events & GameSession::KeyPickedUp) {
+        map_.setKeyHeld(true);  // Doors open: refresh the distance field around them
+        navigation_.setKeyHeld(map_, true);  // ...and the paths to the exit that run through them
+        keyPickupDisplayUntil_ = SDL_GetTicks() + 2500;  // Show notification for 2.5 sec
+    }
 }
 
-// Simple 5x7 block font: 1 = on. Each char is 5 cols, 7 rows. Space = empty.
-static const unsigned char kBlockFont[][35] = {
-    {1,1,1,1,1, 1,0,0,0,0, 1,1,1,0,0, 1,0,0,0,0, 1,0,0,0,0, 1,0,0,0,0, 1,0,0,0,0}, // F
-    {0,0,1,0,0, 0,0,1,0,0, 0,0,1,0,0, 0,0,1,0,0, 0,0,1,0,0, 0,0,1,0,0, 0,0,1,0,0}, // I
-    {1,0,0,0,1, 1,1,0,0,1, 1,0,1,0,1, 1,0,0,1,1, 1,0,0,0,1, 1,0,0,0,1, 1,0,0,0,1}, // N
-    {1,1,1,0,0, 1,0,0,1,0, 1,0,0,1,0, 1,0,0,1,0, 1,0,0,1,0, 1,0,0,1,0, 1,1,1,0,0}, // D
-    {0,0,0,0,0, 0,0,0,0,0, 0,0,0,0,0, 0,0,0,0,0, 0,0,0,0,0, 0,0,0,0,0, 0,0,0,0,0}, // space
-    {1,1,1,1,1, 0,0,1,0,0, 0,0,1,0,0, 0,0,1,0,0, 0,0,1,0,0, 0,0,1,0,0, 0,0,1,0,0}, // T
-    {1,0,0,0,1, 1,0,0,0,1, 1,0,0,0,1, 1,1,1,1,1, 1,0,0,0,1, 1,0,0,0,1, 1,0,0,0,1}, // H
-    {1,1,1,1,1, 1,0,0,0,1, 1,0,0,0,1, 1,1,1,1,1, 1,0,0,0,1, 1,0,0,0,1, 1,1,1,1,1}, // E
-    {0,0,0,0,0, 0,0,0,0,0, 0,0,0,0,0, 0,0,0,0,0, 0,0,0,0,0, 0,0,0,0,0, 0,0,0,0,0}, // space
-    {0,1,1,1,0, 1,0,0,0,1, 1,0,0,0,1, 1,0,0,0,1, 1,0,0,0,1, 1,0,0,0,1, 0,1,1,1,0}, // O
-    {1,1,1,0,0, 1,0,0,1,0, 1,0,0,1,0, 1,1,1,0,0, 1,0,1,0,0, 1,0,0,1,0, 1,0,0,0,1}, // R
-    {1,0,0,0,1, 1,1,0,1,1, 1,0,1,0,1, 1,0,0,0,1, 1,0,0,0,1, 1,0,0,0,1, 1,0,0,0,1}, // W
-    {0,0,1,0,0, 0,0,1,0,0, 0,0,1,0,0, 0,0,1,0,0, 0,0,1,0,0, 0,0,1,0,0, 0,0,1,0,0}, // I
-    {1,0,0,0,1, 1,1,0,0,1, 1,0,1,0,1, 1,0,0,1,1, 1,0,0,0,1, 1,0,0,0,1, 1,0,0,0,1}, // N
-    {1,1,1,1,1, 0,0,1,0,0, 0,0,1,0,0, 0,0,1,0,0, 0,0,1,0,0, 0,0,1,0,0, 0,0,1,0,0}, // !
-    {0,0,1,0,0, 0,1,0,1,0, 1,0,0,0,1, 1,1,1,1,1, 1,0,0,0,1, 1,0,0,0,1, 1,0,0,0,1}, // A
-    {1,1,1,0,0, 1,0,0,1,0, 1,0,0,1,0, 1,1,1,0,0, 1,0,0,1,0, 1,0,0,1,0, 1,1,1,0,0}, // B
-    // Digits 0-9 for timer and score
-    {0,1,1,1,0, 1,0,0,0,1, 1,0,0,0,1, 1,0,0,0,1, 1,0,0,0,1, 1,0,0,0,1, 0,1,1,1,0}, // 0
-    {0,0,1,0,0, 0,1,1,0,0, 0,0,1,0,0, 0,0,1,0,0, 0,0,1,0,0, 0,0,1,0,0, 0,1,1,1,0}, // 1
-    {0,1,1,1,0, 1,0,0,0,1, 0,0,0,0,1, 0,0,1,1,0, 0,1,0,0,0, 1,0,0,0,0, 1,1,1,1,1}, // 2
-    {1,1,1,1,0, 0,0,0,0,1, 0,0,0,1,0, 0,0,1,1,0, 0,0,0,0,1, 1,0,0,0,1, 0,1,1,1,0}, // 3
-    {0,0,0,1,0, 0,0,1,1,0, 0,1,0,1,0, 1,0,0,1,0, 1,1,1,1,1, 0,0,0,1,0, 0,0,0,1,0}, // 4
-    {1,1,1,1,1, 1,0,0,0,0, 1,1,1,1,0, 0,0,0,0,1, 0,0,0,0,1, 1,0,0,0,1, 0,1,1,1,0}, // 5
-    {0,1,1,1,0, 1,0,0,0,0, 1,1,1,1,0, 1,0,0,0,1, 1,0,0,0,1, 1,0,0,0,1, 0,1,1,1,0}, // 6
-    {1,1,1,1,1, 0,0,0,0,1, 0,0,0,1,0, 0,0,1,0,0, 0,1,0,0,0, 0,1,0,0,0, 0,1,0,0,0}, // 7
-    {0,1,1,1,0, 1,0,0,0,1, 1,0,0,0,1, 0,1,1,1,0, 1,0,0,0,1, 1,0,0,0,1, 0,1,1,1,0}, // 8
-    {0,1,1,1,0, 1,0,0,0,1, 1,0,0,0,1, 0,1,1,1,1, 0,0,0,0,1, 0,0,0,0,1, 0,1,1,1,0}, // 9
-    {0,0,0,0,0, 0,0,0,0,0, 0,0,1,0,0, 0,0,0,0,0, 0,0,1,0,0, 0,0,0,0,0, 0,0,0,0,0}, // :
-    {1,0,0,0,0, 1,0,0,0,0, 1,0,0,0,0, 1,0,0,0,0, 1,0,0,0,0, 1,0,0,0,0, 1,1,1,1,1}, // L
-    {0,1,1,1,0, 1,0,0,0,0, 0,1,1,0,0, 0,0,0,1,0, 0,0,0,0,1, 1,0,0,0,1, 0,1,1,1,0}, // S
-    {0,0,0,0,0, 0,0,0,0,0, 0,0,0,0,0, 1,1,1,1,1, 0,0,0,0,0, 0,0,0,0,0, 0,0,0,0,0}, // -
-    {1,0,0,0,1, 1,1,0,1,1, 1,0,1,0,1, 1,0,0,0,1, 1,0,0,0,1, 1,0,0,0,1, 1,0,0,0,1}, // M
-    {0,1,1,1,0, 1,0,0,0,1, 1,0,0,0,0, 1,0,0,0,0, 1,0,0,0,0, 1,0,0,0,1, 0,1,1,1,0}, // C
-};
-static int blockCharIndex(char c) {
-    if (c >= '0' && c <= '9') return 17 + (c - '0');
-    switch (c) {
-        case 'F': return 0; case 'I': return 1; case 'N': return 2; case 'D': return 3;
-        case ' ': return 4; case 'T': return 5; case 'H': return 6; case 'E': return 7;
-        case 'O': return 9; case 'R': return 10; case 'W': return 11; case '!': return 14;
-        case 'A': return 15; case 'B': return 16; case ':': return 27; case 'L': return 28;
-        case 'S': return 29; case '-': return 30; case 'M': return 31; case 'C': return 32;
-        default: return 4;
-    }
+// End of playback: whether the run reproduced the recorded outcome, and how long it took.
+void Game::reportReplay(double seconds) const {
+    const ReplayHeader& h = replay_.header();
+    std::string why;
+    if (playback_->corrupt()) why = "input stream is corrupt";
+    else if (playback_->tick() < h.tickCount) why = "stopped early";
+    else replay_.matches(session_, &why);
+    std::cout << "Replayed " << playback_->tick() << "/" << h.tickCount << " ticks: "
+              << (why.empty() ? "outcome matches" : why) << " (score " << session_.score()
+              << (session_.hasWon() ? ", escaped" : session_.hasLost() ? ", timed out" : "") << ")\n"
+              << replayFrames_ << " frames in " << seconds << " s, "
+              << 1000.0 * seconds / std::max(replayFrames_, 1LL) << " ms per frame\n";
 }
 
-void Game::drawBlockText(SDL_Renderer* r, const char* text, int cx, int cy, int blockW, int blockH, int gap) {
-    int len = 0;
-    for (const char* p = text; *p; p++) len++;
-    int totalW = len * (5 * blockW + gap) - gap;
-    int x = cx - totalW / 2;
-    int y = cy - (7 * blockH) / 2;
-    for (const char* p = text; *p; p++) {
-        int idx = blockCharIndex(*p);
-        if (idx >= 0 && idx < 33) {
-            const unsigned char* g = kBlockFont[idx];
-            for (int row = 0; row < 7; row++)
-                for (int col = 0; col < 5; col++)
-                    if (g[row * 5 + col]) {
-                        SDL_Rect rect = { x + col * blockW, y + row * blockH, blockW, blockH };
-                        SDL_RenderFillRect(r, &rect);
-                    }
-        }
-        x += 5 * blockW + gap;
-    }
+void Game::drawBlockText(Framebuffer& fb, const char* text, int cx, int cy, int blockW, int blockH, int gap,
+                         uint32_t color) {
+    text_.drawBlock(fb, text, cx, cy, blockW, blockH, gap, color, true);
 }
 
-void Game::drawBlockTextLeft(SDL_Renderer* r, const char* text, int x, int y, int blockW, int blockH, int gap) {
-    for (const char* p = text; *p; p++) {
-        int idx = blockCharIndex(*p);
-        if (idx >= 0 && idx < 33) {
-            const unsigned char* g = kBlockFont[idx];
-            for (int row = 0; row < 7; row++)
-                for (int col = 0; col < 5; col++)
-                    if (g[row * 5 + col]) {
-                        SDL_Rect rect = { x + col * blockW, y + row * blockH, blockW, blockH };
-                        SDL_RenderFillRect(r, &rect);
-                    }
-        }
-        x += 5 * blockW + gap;
-    }
+void Game::drawBlockTextLeft(Framebuffer& fb, const char* text, int x, int y, int blockW, int blockH, int gap,
+                             uint32_t color) {
+    text_.drawBlock(fb, text, x, y, blockW, blockH, gap, color, false);
 }
 
 std::string Game::formatTime(double seconds) const {
@@ -371,51 +469,57 @@ std::string Game::formatTime(double seconds) const {
     return std::to_string(m) + ":" + (s < 10 ? "0" : "") + std::to_string(s);
 }
 
-void Game::drawText(SDL_Renderer* r, const char* text, int x, int y, int fontSize, SDL_Color color, bool centerX) {
-#ifdef HAS_SDL2_TTF
-    if (!font_ || !text || !*text) return;
-    TTF_SetFontSize(font_, fontSize);
-    SDL_Surface* surf = TTF_RenderUTF8_Blended(font_, text, color);
-    if (!surf) return;
-    SDL_Texture* tex = SDL_CreateTextureFromSurface(r, surf);
-    SDL_FreeSurface(surf);
-    if (!tex) return;
-    int w, h;
-    SDL_QueryTexture(tex, nullptr, nullptr, &w, &h);
-    SDL_Rect dst = { centerX ? x - w/2 : x, y - h/2, w, h };
-    SDL_RenderCopy(r, tex, nullptr, &dst);
-    SDL_DestroyTexture(tex);
-#else
-    (void)r; (void)text; (void)x; (void)y; (void)fontSize; (void)color; (void)centerX;
-#endif
+void Game::drawText(Framebuffer& fb, const char* text, int x, int y, int fontSize, SDL_Color color, bool centerX) {
+    const uint32_t argb = static_cast<uint32_t>(color.a) << 24 | static_cast<uint32_t>(color.r) << 16 |
+                          static_cast<uint32_t>(color.g) << 8 | color.b;
+    text_.draw(fb, text, x, y, fontSize, argb, centerX);
+}
+
+// --- CPU frame: lock the streaming texture, rasterize straight into it, upload once ---
+Framebuffer* Game::beginFrameCPU() {
+    void* pixels = nullptr;
+    int pitch = 0;
+    if (SDL_LockTexture(frameTexture_, nullptr, &pixels, &pitch) != 0) {
+        std::cerr << "SDL_LockTexture failed: " << SDL_GetError() << "\n";
+        return nullptr;
+    }
+    frame_.attach(static_cast<uint32_t*>(pixels), CPU_WIDTH, CPU_HEIGHT, pitch);
+    return &frame_;
+}
+
+void Game::presentFrameCPU() {
+    ProfileZone zone(profiler_, "present");
+    const TextRenderer::Stats text = text_.endFrame();
+    profiler_.counter("text strings", text.strings);
+    profiler_.counter("text composed", text.composed);
+    SDL_UnlockTexture(frameTexture_);
+    SDL_RenderCopy(sdlRenderer_, frameTexture_, nullptr, nullptr);
+    SDL_RenderPresent(sdlRenderer_);
 }
 
 void Game::renderTitleScreenCPU() {
+    Framebuffer* frame = beginFrameCPU();
+    if (!frame) return;
+    Framebuffer& fb = *frame;
     int w = CPU_WIDTH, h = CPU_HEIGHT;
-    SDL_SetRenderDrawColor(sdlRenderer_, 20, 22, 35, 255);
-    SDL_RenderClear(sdlRenderer_);
-    SDL_Color gold = {255, 220, 100, 255};
-    SDL_Color green = {50, 180, 80, 255};
+    fb.clear(Framebuffer::rgb(20, 22, 35));
+    const uint32_t doorGreen = Framebuffer::rgb(50, 180, 80);
 #ifdef HAS_SDL2_TTF
     if (font_) {
-        drawText(sdlRenderer_, "Find the Green Door", w / 2, h / 2 - 50, 42, gold, true);
-        SDL_Rect doorSample = { w/2 - 60, h/2 + 20, 120, 36 };
-        SDL_SetRenderDrawColor(sdlRenderer_, 50, 180, 80, 255);
-        SDL_RenderFillRect(sdlRenderer_, &doorSample);
-        drawText(sdlRenderer_, "SPACE to start", w / 2, h - 60, 24, gold, true);
+        SDL_Color gold = {255, 220, 100, 255};
+        drawText(fb, "Find the Green Door", w / 2, h / 2 - 50, 42, gold, true);
+        fb.fillRect(w/2 - 60, h/2 + 20, 120, 36, doorGreen);
+        drawText(fb, "SPACE to start", w / 2, h - 60, 24, gold, true);
     } else
 #endif
     {
         int blockW = 14, blockH = 18, gap = 6;
-        SDL_SetRenderDrawColor(sdlRenderer_, 255, 220, 100, 255);
-        drawBlockText(sdlRenderer_, "FIND THE GREEN DOOR", w / 2, h / 2 - 40, blockW, blockH, gap);
-        SDL_SetRenderDrawColor(sdlRenderer_, 50, 180, 80, 255);
-        SDL_Rect doorSample = { w/2 - 60, h/2 + 40, 120, 36 };
-        SDL_RenderFillRect(sdlRenderer_, &doorSample);
-        SDL_SetRenderDrawColor(sdlRenderer_, 255, 220, 100, 255);
-        drawBlockText(sdlRenderer_, "SPACE START", w / 2, h - 50, 8, 11, 4);
+        const uint32_t gold = Framebuffer::rgb(255, 220, 100);
+        drawBlockText(fb, "FIND THE GREEN DOOR", w / 2, h / 2 - 40, blockW, blockH, gap, gold);
+        fb.fillRect(w/2 - 60, h/2 + 40, 120, 36, doorGreen);
+        drawBlockText(fb, "SPACE START", w / 2, h - 50, 8, 11, 4, gold);
     }
-    SDL_RenderPresent(sdlRenderer_);
+    presentFrameCPU();
 }
 
 void Game::renderWinScreenGL() {
@@ -426,32 +530,33 @@ void Game::renderWinScreenGL() {
 }
 
 void Game::renderWinScreenCPU() {
+    Framebuffer* frame = beginFrameCPU();
+    if (!frame) return;
+    Framebuffer& fb = *frame;
     int w = CPU_WIDTH, h = CPU_HEIGHT;
-    SDL_SetRenderDrawColor(sdlRenderer_, 15, 25, 15, 255);
-    SDL_RenderClear(sdlRenderer_);
-    SDL_Color winGreen = {80, 255, 120, 255};
-    SDL_Color lightGray = {200, 220, 200, 255};
+    fb.clear(Framebuffer::rgb(15, 25, 15));
 #ifdef HAS_SDL2_TTF
     if (font_) {
-        drawText(sdlRenderer_, "You found the green door!", w / 2, h / 2 - 60, 28, winGreen, true);
-        drawText(sdlRenderer_, "You Win!", w / 2, h / 2 - 10, 48, winGreen, true);
-        drawText(sdlRenderer_, ("Time: " + formatTime(elapsedTime_)).c_str(), w / 2, h / 2 + 60, 22, lightGray, true);
-        drawText(sdlRenderer_, ("Score: " + std::to_string(score_)).c_str(), w / 2, h / 2 + 95, 22, lightGray, true);
-        drawText(sdlRenderer_, "R = restart", w / 2, h / 2 + 140, 20, lightGray, true);
-        drawText(sdlRenderer_, "ESC = quit", w / 2, h / 2 + 175, 20, lightGray, true);
+        SDL_Color winGreen = {80, 255, 120, 255};
+        SDL_Color lightGray = {200, 220, 200, 255};
+        drawText(fb, "You found the green door!", w / 2, h / 2 - 60, 28, winGreen, true);
+        drawText(fb, "You Win!", w / 2, h / 2 - 10, 48, winGreen, true);
+        drawText(fb, ("Time: " + formatTime(session_.elapsed())).c_str(), w / 2, h / 2 + 60, 22, lightGray, true);
+        drawText(fb, ("Score: " + std::to_string(session_.score())).c_str(), w / 2, h / 2 + 95, 22, lightGray, true);
+        drawText(fb, "R = restart", w / 2, h / 2 + 140, 20, lightGray, true);
+        drawText(fb, "ESC = quit", w / 2, h / 2 + 175, 20, lightGray, true);
     } else
 #endif
     {
-        SDL_SetRenderDrawColor(sdlRenderer_, 80, 255, 120, 255);
-        drawBlockText(sdlRenderer_, "YOU FOUND THE GREEN DOOR", w / 2, h / 2 - 50, 12, 14, 4);
-        drawBlockText(sdlRenderer_, "YOU WIN!", w / 2, h / 2 + 20, 16, 18, 5);
-        SDL_SetRenderDrawColor(sdlRenderer_, 200, 220, 200, 255);
-        drawBlockText(sdlRenderer_, ("TIME: " + formatTime(elapsedTime_)).c_str(), w / 2, h / 2 + 85, 10, 12, 3);
-        drawBlockText(sdlRenderer_, ("SCORE: " + std::to_string(score_)).c_str(), w / 2, h / 2 + 120, 10, 12, 3);
-        SDL_SetRenderDrawColor(sdlRenderer_, 180, 190, 200, 255);
-        drawBlockText(sdlRenderer_, "R RESTART  ESC QUIT", w / 2, h / 2 + 155, 8, 10, 2);
+        const uint32_t winGreen = Framebuffer::rgb(80, 255, 120);
+        const uint32_t lightGray = Framebuffer::rgb(200, 220, 200);
+        drawBlockText(fb, "YOU FOUND THE GREEN DOOR", w / 2, h / 2 - 50, 12, 14, 4, winGreen);
+        drawBlockText(fb, "YOU WIN!", w / 2, h / 2 + 20, 16, 18, 5, winGreen);
+        drawBlockText(fb, ("TIME: " + formatTime(session_.elapsed())).c_str(), w / 2, h / 2 + 85, 10, 12, 3, lightGray);
+        drawBlockText(fb, ("SCORE: " + std::to_string(session_.score())).c_str(), w / 2, h / 2 + 120, 10, 12, 3, lightGray);
+        drawBlockText(fb, "R RESTART  ESC QUIT", w / 2, h / 2 + 155, 8, 10, 2, Framebuffer::rgb(180, 190, 200));
     }
-    SDL_RenderPresent(sdlRenderer_);
+    presentFrameCPU();
 }
 
 void Game::renderTitleScreen() {
@@ -468,88 +573,193 @@ void Game::renderTitleScreen() {
 void Game::renderGL() {
     int w, h;
     SDL_GL_GetDrawableSize(window_, &w, &h);
-    rendererGL_.draw(player_, hasKey_, w, h);
+    {
+        ProfileZone zone(profiler_, "gl submit");
+        rendererGL_.draw(view_, session_.hasKey(), w, h, static_cast<float>(renderScale_.scale()));
+    }
+    profiler_.counter("gpu cast ms", rendererGL_.castGpuMs());
+    profiler_.counter("gpu shade ms", rendererGL_.shadeGpuMs());
+    // The GPU passes are what scales (and CPU time here may include waiting on the swap chain).
+    measureRenderWork(rendererGL_.castGpuMs() + rendererGL_.shadeGpuMs());
+    ProfileZone zone(profiler_, "swap");
     SDL_GL_SwapWindow(window_);
 }
 
 // --- UI: minimap at bottom center to help user find the door ---
-void Game::renderMinimapCPU() {
-    const int mapPx = Map::width * MINIMAP_CELL;
-    const int mapPy = Map::height * MINIMAP_CELL;
+void Game::renderMinimapCPU(Framebuffer& fb) {
+    ProfileZone zone(profiler_, "minimap");
+    // Whole map if it fits, otherwise a MINIMAP_SPAN window around the player.
+    const int spanX = std::min(map_.width(), MINIMAP_SPAN);
+    const int spanY = std::min(map_.height(), MINIMAP_SPAN);
+    const int x0 = std::clamp(static_cast<int>(view_.x) - spanX / 2, 0, map_.width() - spanX);
+    const int y0 = std::clamp(static_cast<int>(view_.y) - spanY / 2, 0, map_.height() - spanY);
+    const int mapPx = spanX * MINIMAP_CELL;
+    const int mapPy = spanY * MINIMAP_CELL;
     const int mx = (CPU_WIDTH - mapPx) / 2;
     const int my = CPU_HEIGHT - MINIMAP_MARGIN - mapPy;
 
-    SDL_Rect bg = { mx - 2, my - 2, mapPx + 4, mapPy + 4 };
-    SDL_SetRenderDrawColor(sdlRenderer_, 20, 20, 30, 230);
-    SDL_RenderFillRect(sdlRenderer_, &bg);
-    SDL_SetRenderDrawColor(sdlRenderer_, 80, 80, 100, 255);
-    SDL_RenderDrawRect(sdlRenderer_, &bg);
-
-    for (int cy = 0; cy < Map::height; ++cy)
-        for (int cx = 0; cx < Map::width; ++cx) {
-            int c = Map::layout[cy][cx];
-            Uint8 r = 60, g = 60, b = 60;
-            if (c == Cell::Wall) { r = 90; g = 85; b = 80; }
-            else if (c == Cell::Door) { r = 100; g = 70; b = 50; }
-            else if (c == Cell::Key) { r = 220; g = 180; b = 40; }
-            else if (c == Cell::Exit) { r = 50; g = 180; b = 80; }
-            SDL_Rect cell = { mx + cx * MINIMAP_CELL, my + cy * MINIMAP_CELL, MINIMAP_CELL, MINIMAP_CELL };
-            SDL_SetRenderDrawColor(sdlRenderer_, r, g, b, 255);
-            SDL_RenderFillRect(sdlRenderer_, &cell);
-        }
+    fb.fillRect(mx - 2, my - 2, mapPx + 4, mapPy + 4, Framebuffer::rgb(20, 20, 30));
+    fb.drawRect(mx - 2, my - 2, mapPx + 4, mapPy + 4, Framebuffer::rgb(80, 80, 100));
+    minimap_.draw(fb, map_, session_.hasKey(), x0, y0, spanX, spanY, mx, my);
+
+    // Dynamic overlays: view cone, player, and a key badge once it is held.
+    const int px = mx + static_cast<int>((view_.x - x0) * MINIMAP_CELL);
+    const int py = my + static_cast<int>((view_.y - y0) * MINIMAP_CELL);
+    const Raycaster::Camera cam = raycaster_.makeCamera(view_);
+    const float coneLength = 3.0f * MINIMAP_CELL;
+    for (float side : {-1.0f, 1.0f}) {
+        const float ex = cam.dirX + side * cam.planeX, ey = cam.dirY + side * cam.planeY;
+        const float scale = coneLength / std::sqrt(ex * ex + ey * ey);
+        fb.drawLine(px, py, px + static_cast<int>(ex * scale), py + static_cast<int>(ey * scale),
+                    Framebuffer::rgb(200, 200, 120));
+    }
+    fb.fillRect(px - 1, py - 1, 3, 3, Framebuffer::rgb(255, 255, 255));
+    if (session_.hasKey()) fb.fillRect(mx + mapPx - 8, my + 2, 6, 6, Framebuffer::rgb(220, 180, 40));
+}
 
-    int px = mx + static_cast<int>(player_.x * MINIMAP_CELL);
-    int py = my + static_cast<int>(player_.y * MINIMAP_CELL);
-    SDL_SetRenderDrawColor(sdlRenderer_, 255, 255, 255, 255);
-    SDL_Rect playerRect = { px - 1, py - 1, 3, 3 };
-    SDL_RenderFillRect(sdlRenderer_, &playerRect);
+// --- UI: arrow at top center along the shortest path to the key, then the exit ---
+void Game::renderCompassCPU(Framebuffer& fb) {
+    const FlowField& field = navigation_.objective(session_.hasKey());
+    int tx = static_cast<int>(view_.x), ty = static_cast<int>(view_.y);
+    if (!field.reachable(tx, ty)) return;
+    // Aim a few cells down the path so the arrow follows the corridor, not each cell edge.
+    for (int i = 0; i < COMPASS_LOOKAHEAD; ++i) {
+        const FlowField::Step step = field.next(tx, ty);
+        tx += step.dx;
+        ty += step.dy;
+    }
+    const float wx = tx + 0.5f - view_.x, wy = ty + 0.5f - view_.y;
+    // In view space: forward is up the screen, the camera plane points right.
+    const Raycaster::Camera cam = raycaster_.makeCamera(view_);
+    const float planeLength = std::sqrt(cam.planeX * cam.planeX + cam.planeY * cam.planeY);
+    const float right = (wx * cam.planeX + wy * cam.planeY) / planeLength;
+    const float ahead = wx * cam.dirX + wy * cam.dirY;
+    const float length = std::sqrt(right * right + ahead * ahead);
+    if (length < 0.05f) return;  // Standing on the objective
+
+    const int size = 48, cx = CPU_WIDTH / 2, cy = MINIMAP_MARGIN + size / 2;
+    fb.fillRect(cx - size / 2, cy - size / 2, size, size, Framebuffer::rgb(15, 18, 28));
+    fb.drawRect(cx - size / 2, cy - size / 2, size, size, Framebuffer::rgb(60, 70, 90));
+    const float ux = right / length, uy = -ahead / length;  // Screen y grows downwards
+    const float reach = size * 0.35f, head = size * 0.15f;
+    const int tipX = cx + static_cast<int>(ux * reach), tipY = cy + static_cast<int>(uy * reach);
+    const uint32_t color = session_.hasKey() ? Framebuffer::rgb(80, 220, 120) : Framebuffer::rgb(255, 215, 0);
+    fb.drawLine(cx - static_cast<int>(ux * reach), cy - static_cast<int>(uy * reach), tipX, tipY, color);
+    for (float side : {-1.0f, 1.0f})
+        fb.drawLine(tipX, tipY, tipX - static_cast<int>((ux - side * uy) * head),
+                    tipY - static_cast<int>((uy + side * ux) * head), color);
 }
 
 void Game::renderCPU() {
-    SDL_SetRenderDrawColor(sdlRenderer_, 70, 130, 180, 255);
-    SDL_RenderClear(sdlRenderer_);
-
-    SDL_SetRenderDrawColor(sdlRenderer_, 50, 50, 50, 255);
-    SDL_Rect floorRect{ 0, CPU_HEIGHT / 2, CPU_WIDTH, CPU_HEIGHT / 2 };
-    SDL_RenderFillRect(sdlRenderer_, &floorRect);
-
-    // --- Raycasting renderer: walls with distance shading (depth effect) ---
-    auto walls = raycaster_.castRays(player_, hasKey_);
-    for (int x = 0; x < CPU_WIDTH; ++x) {
-        float wallHeight = walls[x];
-        int yStart = static_cast<int>((CPU_HEIGHT - wallHeight) / 2.0f);
-        int yEnd   = static_cast<int>((CPU_HEIGHT + wallHeight) / 2.0f);
-        int brightness = std::clamp(255 - static_cast<int>(wallHeight * 2), 50, 255);
-        SDL_SetRenderDrawColor(sdlRenderer_, brightness, brightness / 2, brightness / 2, 255);
-        SDL_RenderDrawLine(sdlRenderer_, x, yStart, x, yEnd);
+    Framebuffer* frame = beginFrameCPU();
+    if (!frame) return;
+    Framebuffer& fb = *frame;
+    const auto started = std::chrono::steady_clock::now();
+
+    // Below full render scale the 3D view is cast into scene_ with fewer columns and rows,
+    // then stretched over the frame; the HUD and minimap are drawn at full resolution.
+    const int sceneWidth = renderScale_.scaled(CPU_WIDTH), sceneHeight = renderScale_.scaled(CPU_HEIGHT);
+    const bool scaled = sceneWidth < CPU_WIDTH || sceneHeight < CPU_HEIGHT;
+    if (scaled)
+        scene_.attach(sceneStorage_.row(0), sceneWidth, sceneHeight,
+                      sceneStorage_.pitch() * static_cast<int>(sizeof(uint32_t)));
+    Framebuffer& scene = scaled ? scene_ : fb;
+    raycaster_.setScreenSize(scene.width(), scene.height());
+
+    // --- Raycasting renderer: textured walls, floor and ceiling; shading and fog from lookup tables ---
+    // Walls are drawn in column tiles and the floor / ceiling in row bands; each pass only
+    // writes its own pixels, so there is no overdraw.
+    {
+        ProfileZone zone(profiler_, "cast");
+        raycaster_.castRays(view_, map_, session_.hasKey(), hits_);
     }
+    {
+        ProfileZone zone(profiler_, "walls");
+        const float* distance = hits_.distance();
+        const float* height = hits_.height();
+        const float* texU = hits_.texU();
+        const uint8_t* cell = hits_.cell();
+        const uint8_t* side = hits_.side();
+        auto drawWalls = [&](int begin, int end) {
+            for (int x = begin; x < end; ++x) {
+                const float wallTop = (sceneHeight - height[x]) / 2.0f;
+                const int top = static_cast<int>(std::ceil(wallTop - 0.5f));
+                const int bottom = static_cast<int>(std::ceil((sceneHeight + height[x]) / 2.0f - 0.5f)) - 1;
+                // 16.16 texel position per row; v0 samples the first covered row at its center.
+                const float texelsPerRow = WallTextures::kSize / std::max(height[x], 1e-3f);
+                const uint32_t vStep = static_cast<uint32_t>(texelsPerRow * 65536.0f);
+                const uint32_t v0 = static_cast<uint32_t>((top + 0.5f - wallTop) * texelsPerRow * 65536.0f);
+                scene.drawTexturedColumn(x, top, bottom, wallTextures_.column(cell[x], texU[x]), WallTextures::kSize - 1,
+                                      v0, vStep, wallTextures_.colormap(distance[x], side[x]));
+                wallTop_[x] = top;
+                wallBottom_[x] = bottom;
+            }
+        };
+        // 16-pixel tiles: each thread writes whole 64-byte lines of every row.
+        if (ThreadPool* pool = raycaster_.threadPool()) pool->parallelFor(scene.width(), 16, drawWalls);
+        else drawWalls(0, scene.width());
+    }
+    {
+        ProfileZone zone(profiler_, "floor");
+        castFloorAndCeiling(scene, raycaster_.makeCamera(view_), wallTextures_, wallTop_.data(), wallBottom_.data(),
+                            raycaster_.simdIsa(), raycaster_.threadPool());
+    }
+    {
+        // Key and exit are billboards on the CPU path (their cells do not stop rays).
+        ProfileZone zone(profiler_, "sprites");
+        const LevelInfo& info = map_.info();
+        sprites_.clear();
+        if (!session_.hasKey() && info.keyX >= 0)
+            sprites_.push_back(Sprite{info.keyX + 0.5f, info.keyY + 0.5f, 0.5f, WallTextures::kSpriteKey});
+        if (info.exitX >= 0)
+            sprites_.push_back(Sprite{info.exitX + 0.5f, info.exitY + 0.5f, 1.0f, WallTextures::kSpriteExit});
+        spriteRenderer_.draw(scene, raycaster_.makeCamera(view_), raycaster_.maxDepth(), hits_.distance(),
+                             sprites_.data(), sprites_.size(), wallTextures_, raycaster_.threadPool());
+    }
+    if (scaled) {
+        ProfileZone zone(profiler_, "upscale");
+        auto stretch = [&](int begin, int end) {
+            fb.stretchImage(scene_.row(0), scene_.pitch(), sceneWidth, sceneHeight, begin, end);
+        };
+        if (ThreadPool* pool = raycaster_.threadPool()) pool->parallelFor(CPU_HEIGHT, 16, stretch);
+        else stretch(0, CPU_HEIGHT);
+    }
+
+    renderHudCPU(fb);
+    renderCompassCPU(fb);
+    renderMinimapCPU(fb);
+    measureRenderWork(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count());
+    presentFrameCPU();
+}
 
+// --- UI: panels and notifications drawn over the CPU frame ---
+void Game::renderHudCPU(Framebuffer& fb) {
+    ProfileZone zone(profiler_, "hud");
     // --- UI: timer and score on screen (top-left), readable font + background ---
     const int uiX = MINIMAP_MARGIN;
     const int uiY = MINIMAP_MARGIN;
     const int lineH = 26;
     const int panelW = 200;
     const int panelH = 100;
-    SDL_Rect panel = { uiX - 4, uiY - 4, panelW, panelH };
-    SDL_SetRenderDrawColor(sdlRenderer_, 15, 18, 28, 230);
-    SDL_RenderFillRect(sdlRenderer_, &panel);
-    SDL_SetRenderDrawColor(sdlRenderer_, 60, 70, 90, 255);
-    SDL_RenderDrawRect(sdlRenderer_, &panel);
-    SDL_Color uiColor = {255, 255, 220, 255};
+    const uint32_t panelFill = Framebuffer::rgb(15, 18, 28);
+    const uint32_t panelEdge = Framebuffer::rgb(60, 70, 90);
+    fb.fillRect(uiX - 4, uiY - 4, panelW, panelH, panelFill);
+    fb.drawRect(uiX - 4, uiY - 4, panelW, panelH, panelEdge);
 #ifdef HAS_SDL2_TTF
     if (font_) {
-        drawText(sdlRenderer_, ("TIME: " + formatTime(elapsedTime_)).c_str(), uiX + 10, uiY + 14, 18, uiColor, false);
-        drawText(sdlRenderer_, ("LEFT: " + formatTime(timer_)).c_str(), uiX + 10, uiY + 14 + lineH, 18, uiColor, false);
-        std::string scoreStr = "SCORE: " + (hasWon_ ? std::to_string(score_) : (hasLost_ ? "0" : "-"));
-        drawText(sdlRenderer_, scoreStr.c_str(), uiX + 10, uiY + 14 + 2*lineH, 18, uiColor, false);
+        SDL_Color uiColor = {255, 255, 220, 255};
+        drawText(fb, ("TIME: " + formatTime(session_.elapsed())).c_str(), uiX + 10, uiY + 14, 18, uiColor, false);
+        drawText(fb, ("LEFT: " + formatTime(session_.timeLeft())).c_str(), uiX + 10, uiY + 14 + lineH, 18, uiColor, false);
+        std::string scoreStr = "SCORE: " + (session_.hasWon() ? std::to_string(session_.score()) : (session_.hasLost() ? "0" : "-"));
+        drawText(fb, scoreStr.c_str(), uiX + 10, uiY + 14 + 2*lineH, 18, uiColor, false);
     } else
 #endif
     {
         const int uiBlockW = 10, uiBlockH = 14, uiGap = 4;
-        SDL_SetRenderDrawColor(sdlRenderer_, 255, 255, 220, 255);
-        drawBlockTextLeft(sdlRenderer_, ("TIME: " + formatTime(elapsedTime_)).c_str(), uiX, uiY, uiBlockW, uiBlockH, uiGap);
-        drawBlockTextLeft(sdlRenderer_, ("LEFT: " + formatTime(timer_)).c_str(), uiX, uiY + lineH, uiBlockW, uiBlockH, uiGap);
-        drawBlockTextLeft(sdlRenderer_, ("SCORE: " + (hasWon_ ? std::to_string(score_) : (hasLost_ ? "0" : "-"))).c_str(), uiX, uiY + 2*lineH, uiBlockW, uiBlockH, uiGap);
+        const uint32_t uiColor = Framebuffer::rgb(255, 255, 220);
+        drawBlockTextLeft(fb, ("TIME: " + formatTime(session_.elapsed())).c_str(), uiX, uiY, uiBlockW, uiBlockH, uiGap, uiColor);
+        drawBlockTextLeft(fb, ("LEFT: " + formatTime(session_.timeLeft())).c_str(), uiX, uiY + lineH, uiBlockW, uiBlockH, uiGap, uiColor);
+        drawBlockTextLeft(fb, ("SCORE: " + (session_.hasWon() ? std::to_string(session_.score()) : (session_.hasLost() ? "0" : "-"))).c_str(), uiX, uiY + 2*lineH, uiBlockW, uiBlockH, uiGap, uiColor);
     }
 
     // Start hint: "Find gold key to open green door" (4 sec)
@@ -557,12 +767,12 @@ void Game::renderCPU() {
 #ifdef HAS_SDL2_TTF
         if (font_) {
             SDL_Color hintColor = {255, 215, 0, 255};
-            drawText(sdlRenderer_, "Find gold key to open green door", CPU_WIDTH / 2, CPU_HEIGHT / 2 - 80, 24, hintColor, true);
+            drawText(fb, "Find gold key to open green door", CPU_WIDTH / 2, CPU_HEIGHT / 2 - 80, 24, hintColor, true);
         } else
 #endif
         {
-            SDL_SetRenderDrawColor(sdlRenderer_, 255, 215, 0, 255);
-            drawBlockText(sdlRenderer_, "FIND GOLD KEY TO OPEN GREEN DOOR", CPU_WIDTH / 2, CPU_HEIGHT / 2 - 70, 10, 12, 3);
+            drawBlockText(fb, "FIND GOLD KEY TO OPEN GREEN DOOR", CPU_WIDTH / 2, CPU_HEIGHT / 2 - 70, 10, 12, 3,
+                          Framebuffer::rgb(255, 215, 0));
         }
     }
     // Key pickup notification (center screen, 2.5 sec)
@@ -570,43 +780,38 @@ void Game::renderCPU() {
 #ifdef HAS_SDL2_TTF
         if (font_) {
             SDL_Color keyColor = {255, 215, 0, 255};
-            drawText(sdlRenderer_, "KEY PICKED UP!", CPU_WIDTH / 2, CPU_HEIGHT / 2 - 60, 32, keyColor, true);
+            drawText(fb, "KEY PICKED UP!", CPU_WIDTH / 2, CPU_HEIGHT / 2 - 60, 32, keyColor, true);
         } else
 #endif
         {
-            SDL_SetRenderDrawColor(sdlRenderer_, 255, 215, 0, 255);
-            drawBlockText(sdlRenderer_, "KEY PICKED UP!", CPU_WIDTH / 2, CPU_HEIGHT / 2 - 50, 12, 14, 4);
+            drawBlockText(fb, "KEY PICKED UP!", CPU_WIDTH / 2, CPU_HEIGHT / 2 - 50, 12, 14, 4,
+                          Framebuffer::rgb(255, 215, 0));
         }
     }
 
     // Controls instruction (top right)
     const int ctrlPanelW = 160;
     const int ctrlPanelH = 120;
-    SDL_Rect ctrlPanel = { CPU_WIDTH - ctrlPanelW - MINIMAP_MARGIN, MINIMAP_MARGIN, ctrlPanelW, ctrlPanelH };
-    const int hintX = ctrlPanel.x + 12;
+    const int ctrlPanelX = CPU_WIDTH - ctrlPanelW - MINIMAP_MARGIN;
     const int hintY = MINIMAP_MARGIN + 20;
-    const int hintLineH = 22;
-    SDL_Color hintColor = {200, 205, 220, 255};
-    SDL_SetRenderDrawColor(sdlRenderer_, 15, 18, 28, 200);
-    SDL_RenderFillRect(sdlRenderer_, &ctrlPanel);
-    SDL_SetRenderDrawColor(sdlRenderer_, 60, 70, 90, 255);
-    SDL_RenderDrawRect(sdlRenderer_, &ctrlPanel);
+    fb.fillRect(ctrlPanelX, MINIMAP_MARGIN, ctrlPanelW, ctrlPanelH, panelFill);
+    fb.drawRect(ctrlPanelX, MINIMAP_MARGIN, ctrlPanelW, ctrlPanelH, panelEdge);
 #ifdef HAS_SDL2_TTF
     if (font_) {
-        drawText(sdlRenderer_, "W -> north", hintX, hintY, 16, hintColor, false);
-        drawText(sdlRenderer_, "A -> west", hintX, hintY + hintLineH, 16, hintColor, false);
-        drawText(sdlRenderer_, "S -> south", hintX, hintY + 2*hintLineH, 16, hintColor, false);
-        drawText(sdlRenderer_, "D -> east", hintX, hintY + 3*hintLineH, 16, hintColor, false);
-        drawText(sdlRenderer_, "R -> restart", hintX, hintY + 4*hintLineH, 16, hintColor, false);
+        const int hintX = ctrlPanelX + 12;
+        const int hintLineH = 22;
+        SDL_Color hintColor = {200, 205, 220, 255};
+        drawText(fb, "W -> north", hintX, hintY, 16, hintColor, false);
+        drawText(fb, "A -> west", hintX, hintY + hintLineH, 16, hintColor, false);
+        drawText(fb, "S -> south", hintX, hintY + 2*hintLineH, 16, hintColor, false);
+        drawText(fb, "D -> east", hintX, hintY + 3*hintLineH, 16, hintColor, false);
+        drawText(fb, "R -> restart", hintX, hintY + 4*hintLineH, 16, hintColor, false);
     } else
 #endif
     {
-        SDL_SetRenderDrawColor(sdlRenderer_, 180, 185, 200, 255);
-        drawBlockText(sdlRenderer_, "W A S D  MOUSE  R RESTART", ctrlPanel.x + ctrlPanelW/2, hintY + 55, 6, 8, 2);
+        drawBlockText(fb, "W A S D  MOUSE  R RESTART", ctrlPanelX + ctrlPanelW/2, hintY + 55, 6, 8, 2,
+                      Framebuffer::rgb(180, 185, 200));
     }
-
-    renderMinimapCPU();
-    SDL_RenderPresent(sdlRenderer_);
 }
 
 void Game::render() {
@@ -614,7 +819,7 @@ void Game::render() {
         renderTitleScreen();
         return;
     }
-    if (hasWon_) {
+    if (session_.hasWon()) {
         if (useCpuRenderer_)
             renderWinScreenCPU();
         else
@@ -627,30 +832,129 @@ void Game::render() {
         renderGL();
 }
 
+Game::FrameState Game::frameState() const {
+    FrameState state;
+    state.screen = showTitleScreen_ ? 0 : (session_.hasWon() ? 2 : 1);
+    if (state.screen == 0) return state;
+    state.elapsedSeconds = static_cast<int>(session_.elapsed());
+    state.score = session_.score();
+    if (state.screen == 2) return state;
+    state.x = view_.x;
+    state.y = view_.y;
+    state.angle = view_.angle;
+    state.leftSeconds = static_cast<int>(session_.timeLeft());
+    state.hasKey = session_.hasKey();
+    state.hasLost = session_.hasLost();
+    state.startHint = SDL_GetTicks() < startHintDisplayUntil_;
+    state.keyHint = SDL_GetTicks() < keyPickupDisplayUntil_;
+    return state;
+}
+
 /*
- * Main loop: handle input, game logic, rendering. Target ~60 FPS with vsync.
+ * Main loop: poll input once per frame, advance the simulation in fixed TICK_SECONDS steps,
+ * then render the player interpolated between the last two ticks. Rendering runs as fast
+ * as the pacing mode allows while the timer and score stay tick-exact. In on-demand mode
+ * a frame identical to the one on screen is skipped and the loop sleeps until an event
+ * arrives (or the timer may have moved), so static screens and a still player cost
+ * almost nothing.
  */
 void Game::run() {
-    Uint32 lastTime = SDL_GetTicks();
+    pacer_.start(pacing_, frameLimitHz_);
+    if (frameBudgetMs_ <= 0.0) frameBudgetMs_ = defaultFrameBudgetMs();
+    renderScale_.setBudget(frameBudgetMs_);
+    double frameSeconds = 0.0;
+    double accumulator = 0.0;  // Simulation time not yet ticked; view_ is this far past the last tick
+    const auto started = std::chrono::steady_clock::now();
 
     while (running_) {
-        Uint32 currentTime = SDL_GetTicks();
-        double deltaTime = static_cast<double>(currentTime - lastTime) / 1000.0;
-        lastTime = currentTime;
-
-        processInput(deltaTime);
-        render();
+        ProfileZone zone(profiler_, "frame");
+        processInput();
+        if (playback_ && replayFast_) {
+            // Fast replay: exactly one tick per frame, so every build renders the same frames.
+            ProfileZone simulationZone(profiler_, "simulation");
+            previous_ = session_.player();
+            simulate(TICK_SECONDS);
+        } else if (!showTitleScreen_) {
+            ProfileZone simulationZone(profiler_, "simulation");
+            accumulator += std::min(frameSeconds, MAX_FRAME_SECONDS);  // Don't spiral after a stall
+            while (accumulator >= TICK_SECONDS) {
+                previous_ = session_.player();
+                simulate(TICK_SECONDS);
+                accumulator -= TICK_SECONDS;
+            }
+        }
+        view_ = interpolate(previous_, session_.player(), accumulator / TICK_SECONDS);
+        const FrameState state = frameState();
+        if (onDemand_ && !redraw_ && state == lastFrame_) {
+            ++skippedFrames_;
+            profiler_.counter("skipped frames", static_cast<double>(skippedFrames_));
+            ProfileZone idleZone(profiler_, "idle");
+            SDL_WaitEventTimeout(nullptr, static_cast<int>(state.screen == 1 ? IDLE_WAIT_MS : STATIC_WAIT_MS));
+        } else {
+            lastFrame_ = state;
+            redraw_ = false;
+            updateTitle();
+            render();
+        }
+        frameSeconds = pacer_.endFrame();
+        profiler_.counter("frame ms", frameSeconds * 1000.0);
+        if (playback_) ++replayFrames_;
     }
+    if (playback_) reportReplay(std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count());
+    if (recorder_ && recorder_->save(recordPath_, session_))
+        std::cout << "Recorded " << recorder_->ticks() << " ticks (" << recorder_->inputBytes() << " bytes of input) to "
+                  << recordPath_ << "\n";
+    if (traceAtExit_ && profiler_.writeChromeTrace(tracePath_))
+        std::cout << "Wrote frame trace to " << tracePath_ << "\n";
 }
 
 /*
  * Entry point: initialize (window, GL or CPU renderer, maze), then run main loop.
  */
 int main(int argc, char* argv[]) {
-    (void)argc;
-    (void)argv;
     auto game = std::make_unique<Game>();
+    FramePacing pacing = FramePacing::VSync;
+    double limitHz = 144.0;
+
+    // --threads N: CPU raycaster threads (default: all hardware threads)
+    // --level FILE: play a level file instead of the built-in maze
+    // --pacing vsync|adaptive|uncapped|limit, --fps N: frame pacing (limit defaults to 144 fps)
+    // --profile FILE: write the frame profile as Chrome trace JSON at exit (F9 writes it any time)
+    // --on-demand: only render frames that differ from the one on screen; sleep otherwise
+    // --record FILE: save every tick's input (and the outcome) as a replay at exit
+    // --replay FILE: play a recorded run in real time; with --replay-fast, one tick per frame,
+    //   uncapped unless --pacing is given. Prints whether the recorded outcome was reproduced.
+    // --render-scale auto|S: draw the 3D view at S (0.1-1) of the output resolution, or adapt it
+    //   to the frame budget (default auto)
+    // --frame-budget MS: render time auto scaling aims under (default one refresh, or the --fps period)
+    bool pacingGiven = false, replayFast = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--threads" && i + 1 < argc) game->setRenderThreads(std::atoi(argv[++i]));
+        else if (arg == "--level" && i + 1 < argc && !game->loadLevel(argv[++i])) return 1;
+        else if (arg == "--profile" && i + 1 < argc) game->setTraceFile(argv[++i]);
+        else if (arg == "--on-demand") game->setOnDemand(true);
+        else if (arg == "--record" && i + 1 < argc) game->setRecordFile(argv[++i]);
+        else if (arg == "--replay" && i + 1 < argc && !game->loadReplay(argv[++i])) return 1;
+        else if (arg == "--replay-fast") replayFast = true;
+        else if (arg == "--render-scale" && i + 1 < argc) {
+            const std::string value = argv[++i];
+            game->setRenderScale(value == "auto" ? 0.0 : std::atof(value.c_str()));
+        } else if (arg == "--frame-budget" && i + 1 < argc) game->setFrameBudget(std::atof(argv[++i]));
+        else if (arg == "--pacing" && i + 1 < argc) {
+            pacingGiven = true;
+            if (!parseFramePacing(argv[++i], pacing)) {
+                std::cerr << "Unknown pacing mode " << argv[i] << " (vsync, adaptive, uncapped, limit)\n";
+                return 1;
+            }
+        } else if (arg == "--fps" && i + 1 < argc) {
+            limitHz = std::atof(argv[++i]);
+        }
+    }
 
+    if (replayFast && !pacingGiven) pacing = FramePacing::Uncapped;
+    game->setReplayFast(replayFast);
+    game->setFramePacing(pacing, limitHz);
     if (!game->initialize())
         return 1;
 
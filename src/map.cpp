@@ -1,45 +1,144 @@
 #include "map.h"
+#include "mapped_file.h"
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
 
 /*
  * Dungeon maze: 24x24. 0=empty, 1=wall, 2=locked door, 3=key, 4=green exit door.
  * Get the key, pass the brown locked door, reach the green door to win.
  */
-const std::array<std::array<int, Map::width>, Map::height> Map::layout = {{
-    {{1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1}},
-    {{1,0,0,0,1,0,0,0,0,0,1,0,0,0,0,0,0,0,1,0,0,0,0,1}},
-    {{1,0,0,0,1,0,0,0,0,0,1,0,0,0,0,0,0,0,1,0,0,0,0,1}},
-    {{1,0,0,0,1,1,1,1,0,0,1,1,1,1,1,0,0,0,1,1,1,0,0,1}},
-    {{1,0,0,0,0,0,0,1,0,0,0,0,0,0,1,0,0,0,0,0,1,0,0,1}},
-    {{1,1,1,1,0,0,0,1,0,0,0,0,0,0,1,1,1,1,0,0,1,0,0,1}},
-    {{1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,1,0,0,1}},
-    {{1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,1,0,0,1}},
-    {{1,0,0,0,0,0,0,0,1,1,1,1,1,0,0,0,0,0,0,0,0,0,0,1}},
-    {{1,0,0,0,0,0,0,0,1,3,0,0,1,0,0,0,0,0,0,0,0,0,0,1}},
-    {{1,0,0,0,0,0,0,0,1,0,0,0,1,1,1,1,1,1,0,0,0,0,0,1}},
-    {{1,1,1,1,1,1,0,0,1,0,0,0,0,0,0,0,0,1,0,0,0,0,0,1}},
-    {{1,0,0,0,0,0,0,0,1,1,1,0,0,0,0,0,0,1,0,0,1,1,1,1}},
-    {{1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,1,0,0,0,0,0,1}},
-    {{1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,1,0,0,0,0,0,1}},
-    {{1,1,1,1,1,1,1,1,1,0,0,0,0,0,0,0,0,1,1,1,1,0,0,1}},
-    {{1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,1}},
-    {{1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,1}},
-    {{1,0,0,0,0,0,1,1,1,1,1,2,1,1,1,1,1,0,0,0,0,0,0,1}},
-    {{1,0,0,0,0,0,1,0,0,0,0,0,0,0,0,0,1,0,0,0,0,0,0,1}},
-    {{1,0,0,0,0,0,1,0,0,0,0,0,0,0,0,0,1,0,0,0,0,0,0,1}},
-    {{1,0,0,0,0,0,1,0,0,0,0,0,0,0,4,0,1,0,0,0,0,0,0,1}},
-    {{1,0,0,0,0,0,1,1,1,1,1,1,1,1,1,1,1,0,0,0,0,0,0,1}},
-    {{1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1}}
-}};
-
-int Map::getCell(int x, int y) {
-    if (x < 0 || x >= width || y < 0 || y >= height) return Cell::Wall;
-    return layout[y][x];
+static const int kBuiltinWidth = 24;
+static const int kBuiltinHeight = 24;
+static const int kBuiltinLayout[kBuiltinHeight][kBuiltinWidth] = {
+    {1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1},
+    {1,0,0,0,1,0,0,0,0,0,1,0,0,0,0,0,0,0,1,0,0,0,0,1},
+    {1,0,0,0,1,0,0,0,0,0,1,0,0,0,0,0,0,0,1,0,0,0,0,1},
+    {1,0,0,0,1,1,1,1,0,0,1,1,1,1,1,0,0,0,1,1,1,0,0,1},
+    {1,0,0,0,0,0,0,1,0,0,0,0,0,0,1,0,0,0,0,0,1,0,0,1},
+    {1,1,1,1,0,0,0,1,0,0,0,0,0,0,1,1,1,1,0,0,1,0,0,1},
+    {1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,1,0,0,1},
+    {1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,1,0,0,1},
+    {1,0,0,0,0,0,0,0,1,1,1,1,1,0,0,0,0,0,0,0,0,0,0,1},
+    {1,0,0,0,0,0,0,0,1,3,0,0,1,0,0,0,0,0,0,0,0,0,0,1},
+    {1,0,0,0,0,0,0,0,1,0,0,0,1,1,1,1,1,1,0,0,0,0,0,1},
+    {1,1,1,1,1,1,0,0,1,0,0,0,0,0,0,0,0,1,0,0,0,0,0,1},
+    {1,0,0,0,0,0,0,0,1,1,1,0,0,0,0,0,0,1,0,0,1,1,1,1},
+    {1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,1,0,0,0,0,0,1},
+    {1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,1,0,0,0,0,0,1},
+    {1,1,1,1,1,1,1,1,1,0,0,0,0,0,0,0,0,1,1,1,1,0,0,1},
+    {1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,1},
+    {1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,1},
+    {1,0,0,0,0,0,1,1,1,1,1,2,1,1,1,1,1,0,0,0,0,0,0,1},
+    {1,0,0,0,0,0,1,0,0,0,0,0,0,0,0,0,1,0,0,0,0,0,0,1},
+    {1,0,0,0,0,0,1,0,0,0,0,0,0,0,0,0,1,0,0,0,0,0,0,1},
+    {1,0,0,0,0,0,1,0,0,0,0,0,0,0,4,0,1,0,0,0,0,0,0,1},
+    {1,0,0,0,0,0,1,1,1,1,1,1,1,1,1,1,1,0,0,0,0,0,0,1},
+    {1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1}
+};
+
+static const char kLevelMagic[8] = {'R', 'C', 'L', 'E', 'V', 'E', 'L', '\0'};
+
+Map::Map() : tiles_(kBuiltinLayout[0], kBuiltinWidth, kBuiltinHeight) {
+    for (int y = 0; y < kBuiltinHeight; ++y)
+        for (int x = 0; x < kBuiltinWidth; ++x) {
+            if (kBuiltinLayout[y][x] == Cell::Key) { info_.keyX = x; info_.keyY = y; }
+            if (kBuiltinLayout[y][x] == Cell::Exit) { info_.exitX = x; info_.exitY = y; }
+        }
+}
+
+Map::Map(TileMap tiles, const LevelInfo& info) : tiles_(std::move(tiles)), info_(info) {}
+
+Map::~Map() = default;
+Map::Map(Map&&) noexcept = default;
+Map& Map::operator=(Map&&) noexcept = default;
+
+void Map::buildDistanceField(int threads) {
+    field_.build(tiles_, field_.hasKey(), threads);
 }
 
-bool Map::isBlocking(int x, int y, bool hasKey) {
-    if (x < 0 || x >= width || y < 0 || y >= height) return true;
-    int c = layout[y][x];
-    if (c == Cell::Wall) return true;
-    if (c == Cell::Door) return !hasKey;  // brown door opens when you have the key
-    return false;
+bool Map::load(const std::string& path) {
+    auto file = std::make_unique<MappedFile>();
+    if (!file->open(path)) return false;
+
+    // Validation only reads the header; the cell and bitplane pages are faulted in on use.
+    LevelFileHeader h;
+    if (file->size() < sizeof(h)) {
+        std::cerr << path << ": not a level file (too small)\n";
+        return false;
+    }
+    std::memcpy(&h, file->data(), sizeof(h));
+    if (std::memcmp(h.magic, kLevelMagic, sizeof(kLevelMagic)) != 0) {
+        std::cerr << path << ": not a level file (bad magic)\n";
+        return false;
+    }
+    if (h.version != LevelFileHeader::kVersion || h.headerBytes != sizeof(h)) {
+        std::cerr << path << ": unsupported level version " << h.version << "\n";
+        return false;
+    }
+    if (h.width <= 0 || h.height <= 0 || h.tileSize != TileMap::kTileSize ||
+        h.tilesBytes != TileMap::storageBytes(h.width, h.height) || h.tilesOffset % 64 != 0 ||
+        h.tilesOffset > file->size() || h.tilesBytes > file->size() - h.tilesOffset) {
+        std::cerr << path << ": corrupt level header\n";
+        return false;
+    }
+
+    // Spawn, key and exit come straight from the file: a NaN or off-map spawn, or one
+    // inside a wall, would leave the player stuck or feed NaN into cell lookups.
+    TileMap tiles = TileMap::view(file->data() + h.tilesOffset, h.width, h.height);
+    auto inside = [&](int x, int y) { return x >= 0 && y >= 0 && x < h.width && y < h.height; };
+    auto unsetOrInside = [&](int x, int y) { return (x == -1 && y == -1) || inside(x, y); };
+    if (!std::isfinite(h.spawnX) || !std::isfinite(h.spawnY) || !std::isfinite(h.spawnAngle) ||
+        !(h.spawnX >= 0.0f && h.spawnX < h.width && h.spawnY >= 0.0f && h.spawnY < h.height) ||
+        tiles.blocks(static_cast<int>(h.spawnX), static_cast<int>(h.spawnY), false)) {
+        std::cerr << path << ": spawn point is not on an open cell of the map\n";
+        return false;
+    }
+    if (!unsetOrInside(h.keyX, h.keyY) || !unsetOrInside(h.exitX, h.exitY)) {
+        std::cerr << path << ": key or exit cell is outside the map\n";
+        return false;
+    }
+
+    tiles_ = std::move(tiles);
+    field_ = DistanceField();
+    pyramid_ = OccupancyPyramid();
+    info_.spawnX = h.spawnX;
+    info_.spawnY = h.spawnY;
+    info_.spawnAngle = h.spawnAngle;
+    info_.keyX = h.keyX;
+    info_.keyY = h.keyY;
+    info_.exitX = h.exitX;
+    info_.exitY = h.exitY;
+    file_ = std::move(file);
+    return true;
+}
+
+bool Map::save(const std::string& path) const {
+    LevelFileHeader h;
+    std::memset(&h, 0, sizeof(h));
+    std::memcpy(h.magic, kLevelMagic, sizeof(kLevelMagic));
+    h.version = LevelFileHeader::kVersion;
+    h.headerBytes = sizeof(h);
+    h.width = width();
+    h.height = height();
+    h.tileSize = TileMap::kTileSize;
+    h.spawnX = info_.spawnX;
+    h.spawnY = info_.spawnY;
+    h.spawnAngle = info_.spawnAngle;
+    h.keyX = info_.keyX;
+    h.keyY = info_.keyY;
+    h.exitX = info_.exitX;
+    h.exitY = info_.exitY;
+    h.tilesOffset = sizeof(h);
+    h.tilesBytes = tiles_.bytes();
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+    out.write(reinterpret_cast<const char*>(tiles_.storage()), static_cast<std::streamsize>(h.tilesBytes));
+    if (!out) {
+        std::cerr << "Cannot write " << path << "\n";
+        return false;
+    }
+    return true;
 }
@@ -0,0 +1,41 @@
+#include "minimap_cache.h"
+#include "map.h"
+#include <algorithm>
+
+namespace {
+
+uint32_t cellColor(int cell, bool hasKey) {
+    switch (cell) {
+        case Cell::Wall: return Framebuffer::rgb(90, 85, 80);
+        case Cell::Door: return hasKey ? Framebuffer::rgb(70, 55, 45) : Framebuffer::rgb(100, 70, 50);  // Open / shut
+        case Cell::Key:  return hasKey ? Framebuffer::rgb(60, 60, 60) : Framebuffer::rgb(220, 180, 40);  // Picked up
+        case Cell::Exit: return Framebuffer::rgb(50, 180, 80);
+        default:         return Framebuffer::rgb(60, 60, 60);
+    }
+}
+
+} // namespace
+
+void MinimapCache::draw(Framebuffer& fb, const Map& map, bool hasKey, int x0, int y0, int spanX, int spanY,
+                        int sx, int sy) {
+    const bool inside = x0 >= originX_ && y0 >= originY_ && x0 + spanX <= originX_ + cellsX_ &&
+                        y0 + spanY <= originY_ + cellsY_;
+    if (!valid_ || hasKey != hasKey_ || !inside) rebuild(map, hasKey, x0, y0, spanX, spanY);
+    const uint32_t* src = layer_.row((y0 - originY_) * cellPixels_) + (x0 - originX_) * cellPixels_;
+    fb.copyImage(src, layer_.pitch(), spanX * cellPixels_, spanY * cellPixels_, sx, sy);
+}
+
+void MinimapCache::rebuild(const Map& map, bool hasKey, int x0, int y0, int spanX, int spanY) {
+    cellsX_ = std::min(map.width(), spanX + 2 * kMarginCells);
+    cellsY_ = std::min(map.height(), spanY + 2 * kMarginCells);
+    originX_ = std::clamp(x0 - kMarginCells, 0, map.width() - cellsX_);
+    originY_ = std::clamp(y0 - kMarginCells, 0, map.height() - cellsY_);
+    if (layer_.width() != cellsX_ * cellPixels_ || layer_.height() != cellsY_ * cellPixels_)
+        layer_.allocate(cellsX_ * cellPixels_, cellsY_ * cellPixels_);
+    for (int cy = 0; cy < cellsY_; ++cy)
+        for (int cx = 0; cx < cellsX_; ++cx)
+            layer_.fillRect(cx * cellPixels_, cy * cellPixels_, cellPixels_, cellPixels_,
+                            cellColor(map.getCell(originX_ + cx, originY_ + cy), hasKey));
+    hasKey_ = hasKey;
+    valid_ = true;
+}
@@ -0,0 +1,145 @@
+/*
+ * Flow fields. Reachable neighbours are at distance d - 1, d or d + 1, and those are
+ * distinct mod 3, so one 2-bit code per cell orders a cell against its neighbours.
+ */
+#include "navigation.h"
+#include "map.h"
+#include <algorithm>
+
+namespace {
+
+constexpr int kDx[4] = {1, -1, 0, 0};
+constexpr int kDy[4] = {0, 0, 1, -1};
+constexpr uint64_t kColumn0 = 0x0101010101010101ull;  // x & 7 == 0 in a tile word
+constexpr uint64_t kColumn7 = 0x8080808080808080ull;  // x & 7 == 7
+
+} // namespace
+
+void FlowField::setCode(int x, int y, int code) {
+    const size_t t = static_cast<size_t>(CellGrid::tile(x, y, tilesX_)) * 2;
+    const uint64_t bit = uint64_t(1) << CellGrid::bit(x, y);
+    codes_[t] = (code & 1) ? codes_[t] | bit : codes_[t] & ~bit;
+    codes_[t + 1] = (code & 2) ? codes_[t + 1] | bit : codes_[t + 1] & ~bit;
+}
+
+void FlowField::setCodes(int tile, uint64_t cells, long long dist) {
+    // Only ever called on kUnreachable cells, whose bits are all set.
+    const int code = static_cast<int>(dist % 3);
+    if (!(code & 1)) codes_[static_cast<size_t>(tile) * 2] &= ~cells;
+    if (!(code & 2)) codes_[static_cast<size_t>(tile) * 2 + 1] &= ~cells;
+}
+
+void FlowField::spread(const std::vector<TileBits>& frontier, std::vector<uint64_t>& pending,
+                       std::vector<int>& touched) const {
+    // Branch-free: whether a word is empty is a coin toss, so the tile is always written
+    // to touched and only kept when this is the first bit pending there.
+    const int tiles = static_cast<int>(pending.size());
+    size_t count = touched.size();
+    touched.resize(count + frontier.size() * 5);
+    auto add = [&](int tile, uint64_t bits) {
+        touched[count] = tile;
+        count += (pending[tile] == 0) & (bits != 0);
+        pending[tile] |= bits;
+    };
+    for (const TileBits& f : frontier) {
+        const uint64_t b = f.bits;
+        const int tx = f.tile % tilesX_;
+        add(f.tile, ((b << 1) & ~kColumn0) | ((b >> 1) & ~kColumn7) | (b << 8) | (b >> 8));
+        if (tx > 0) add(f.tile - 1, (b & kColumn0) << 7);
+        if (tx < tilesX_ - 1) add(f.tile + 1, (b & kColumn7) >> 7);
+        if (f.tile >= tilesX_) add(f.tile - tilesX_, b << 56);
+        if (f.tile + tilesX_ < tiles) add(f.tile + tilesX_, b >> 56);
+    }
+    touched.resize(count);
+}
+
+void FlowField::build(const TileMap& tiles, int targetX, int targetY, bool hasKey) {
+    width_ = tiles.width();
+    height_ = tiles.height();
+    tilesX_ = (width_ + TileMap::kTileSize - 1) / TileMap::kTileSize;
+    const int tilesY = (height_ + TileMap::kTileSize - 1) / TileMap::kTileSize;
+    targetX_ = targetX;
+    targetY_ = targetY;
+    hasKey_ = hasKey;
+
+    // Every cell starts kUnreachable except the padding of edge tiles, which starts at 0
+    // so the searches, which look for kUnreachable cells, never enter it.
+    codes_.resize(static_cast<size_t>(tilesX_) * tilesY * 2);
+    for (int ty = 0; ty < tilesY; ++ty)
+        for (int tx = 0; tx < tilesX_; ++tx) {
+            const int cols = std::min(width_ - tx * TileMap::kTileSize, TileMap::kTileSize);
+            const int rows = std::min(height_ - ty * TileMap::kTileSize, TileMap::kTileSize);
+            const uint64_t row = (uint64_t(1) << cols) - 1;
+            uint64_t inside = 0;
+            for (int y = 0; y < rows; ++y) inside |= row << (y * TileMap::kTileSize);
+            codes_[(static_cast<size_t>(ty) * tilesX_ + tx) * 2] = inside;
+            codes_[(static_cast<size_t>(ty) * tilesX_ + tx) * 2 + 1] = inside;
+        }
+
+    const CellGrid g = tiles.grid(hasKey);
+    if (!g.inside(targetX, targetY) || g(targetX, targetY) != Cell::Empty) return;
+    // Level by level, a tile word at a time: the next level is the frontier's neighbours
+    // that are passable and still kUnreachable.
+    std::vector<uint64_t> pending(codes_.size() / 2, 0);
+    std::vector<int> touched;
+    std::vector<TileBits> frontier{TileBits{CellGrid::tile(targetX, targetY, tilesX_),
+                                            uint64_t(1) << CellGrid::bit(targetX, targetY)}};
+    std::vector<TileBits> next;
+    setCode(targetX, targetY, 0);
+    for (long long d = 1; !frontier.empty(); ++d) {
+        touched.clear();
+        spread(frontier, pending, touched);
+        next.resize(touched.size());
+        size_t count = 0;
+        for (int t : touched) {
+            const uint64_t cells = pending[t] & ~g.blocking[t] & codes_[static_cast<size_t>(t) * 2] &
+                                   codes_[static_cast<size_t>(t) * 2 + 1];
+            pending[t] = 0;
+            setCodes(t, cells, d);
+            next[count] = TileBits{t, cells};
+            count += cells != 0;
+        }
+        next.resize(count);
+        frontier.swap(next);
+    }
+}
+
+void FlowField::setKeyState(const TileMap& tiles, bool hasKey) {
+    if (hasKey == hasKey_) return;
+    if (empty()) {
+        hasKey_ = hasKey;  // build() will use the new state
+        return;
+    }
+    build(tiles, targetX_, targetY_, hasKey);
+}
+
+FlowField::Step FlowField::next(int x, int y) const {
+    const int c = code(x, y);
+    if (c == kUnreachable || (x == targetX_ && y == targetY_)) return Step{};
+    const int closer = (c + 2) % 3;
+    for (int k = 0; k < 4; ++k)
+        if (code(x + kDx[k], y + kDy[k]) == closer) return Step{kDx[k], kDy[k]};
+    return Step{};
+}
+
+long long FlowField::distance(int x, int y) const {
+    if (!reachable(x, y)) return -1;
+    long long steps = 0;
+    while (x != targetX_ || y != targetY_) {
+        const Step s = next(x, y);
+        x += s.dx;
+        y += s.dy;
+        ++steps;
+    }
+    return steps;
+}
+
+void Navigation::build(const Map& map, bool hasKey) {
+    const LevelInfo& info = map.info();
+    toKey_.build(map.tiles(), info.keyX, info.keyY, false);
+    toExit_.build(map.tiles(), info.exitX, info.exitY, hasKey);
+}
+
+void Navigation::setKeyHeld(const Map& map, bool hasKey) {
+    toExit_.setKeyState(map.tiles(), hasKey);
+}
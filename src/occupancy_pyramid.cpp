@@ -0,0 +1,68 @@
+/*
+ * Occupancy pyramid: level 4 reduces 2x2 tiles, every level above reduces 2x2 nodes of the
+ * one below. Children past the map edge count as occupied so no block ever lets a ray jump
+ * off the map.
+ */
+#include "occupancy_pyramid.h"
+
+void OccupancyPyramid::build(const TileMap& tiles) {
+    const int tilesX = (tiles.width() + TileMap::kTileSize - 1) / TileMap::kTileSize;
+    const int tilesY = (tiles.height() + TileMap::kTileSize - 1) / TileMap::kTileSize;
+
+    // Level sizes: keep halving until one node covers the whole map.
+    offsets_.assign(PyramidGrid::kTileLevels, 0);
+    nodesX_.assign(PyramidGrid::kTileLevels, 0);
+    std::vector<int> nodesY(PyramidGrid::kTileLevels, 0);
+    size_t total = 0;
+    for (int k = PyramidGrid::kTileLevels, nx = tilesX, ny = tilesY;
+         k < PyramidGrid::kMaxLevels && (k == PyramidGrid::kTileLevels || nx > 1 || ny > 1); ++k) {
+        nx = (nx + 1) / 2;
+        ny = (ny + 1) / 2;
+        offsets_.push_back(total);
+        nodesX_.push_back(nx);
+        nodesY.push_back(ny);
+        total += static_cast<size_t>(nx) * ny;
+    }
+    levels_ = static_cast<int>(offsets_.size());
+
+    for (int hasKey = 0; hasKey < 2; ++hasKey) {
+        const CellGrid g = tiles.grid(hasKey != 0);
+        std::vector<uint8_t>& nodes = nodes_[hasKey];
+        nodes.assign(total, 0);
+
+        auto tileOccupied = [&](int tx, int ty) {
+            if (tx >= tilesX || ty >= tilesY) return true;
+            const int rx = g.width - tx * 8, ry = g.height - ty * 8;
+            return g.blocking[static_cast<size_t>(ty) * tilesX + tx] != 0 || rx < 8 || ry < 8;
+        };
+        const int k0 = PyramidGrid::kTileLevels;
+        uint8_t* level = &nodes[offsets_[k0]];
+        for (int ny = 0; ny < nodesY[k0]; ++ny)
+            for (int nx = 0; nx < nodesX_[k0]; ++nx)
+                level[static_cast<size_t>(ny) * nodesX_[k0] + nx] =
+                    tileOccupied(2 * nx, 2 * ny) || tileOccupied(2 * nx + 1, 2 * ny) ||
+                    tileOccupied(2 * nx, 2 * ny + 1) || tileOccupied(2 * nx + 1, 2 * ny + 1);
+
+        for (int k = k0 + 1; k < levels_; ++k) {
+            const uint8_t* below = &nodes[offsets_[k - 1]];
+            const int bx = nodesX_[k - 1], by = nodesY[k - 1];
+            auto child = [&](int x, int y) { return x >= bx || y >= by || below[static_cast<size_t>(y) * bx + x]; };
+            level = &nodes[offsets_[k]];
+            for (int ny = 0; ny < nodesY[k]; ++ny)
+                for (int nx = 0; nx < nodesX_[k]; ++nx)
+                    level[static_cast<size_t>(ny) * nodesX_[k] + nx] =
+                        child(2 * nx, 2 * ny) || child(2 * nx + 1, 2 * ny) ||
+                        child(2 * nx, 2 * ny + 1) || child(2 * nx + 1, 2 * ny + 1);
+        }
+    }
+}
+
+PyramidGrid OccupancyPyramid::grid(bool hasKey) const {
+    PyramidGrid p;
+    p.levels = levels_;
+    for (int k = PyramidGrid::kTileLevels; k < levels_; ++k) {
+        p.nodes[k] = nodes_[hasKey ? 1 : 0].data() + offsets_[k];
+        p.nodesX[k] = nodesX_[k];
+    }
+    return p;
+}
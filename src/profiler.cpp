@@ -0,0 +1,86 @@
+/*
+ * Profiler ring: writers claim a slot with one fetch_add on head_, mark it busy (seq = 0),
+ * fill it and publish it with seq = index + 1. The dump reads seq before and after copying
+ * a slot and drops the event if it changed or belongs to another lap of the ring.
+ */
+#include "profiler.h"
+#include <cstdio>
+#include <iostream>
+#include <vector>
+
+Profiler::Profiler(int capacity) {
+    uint64_t size = 1;
+    while (size < static_cast<uint64_t>(capacity > 1 ? capacity : 1)) size <<= 1;
+    slots_ = std::make_unique<Slot[]>(size);
+    mask_ = size - 1;
+}
+
+uint32_t Profiler::threadIndex() {
+    static std::atomic<uint32_t> next{0};
+    thread_local uint32_t index = next.fetch_add(1, std::memory_order_relaxed);
+    return index;
+}
+
+void Profiler::push(const char* name, int64_t startNs, int64_t value, char phase) {
+    if (!enabled()) return;
+    const uint64_t index = head_.fetch_add(1, std::memory_order_relaxed);
+    Slot& slot = slots_[index & mask_];
+    slot.seq.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.event = Event{name, startNs, value, threadIndex(), phase};
+    slot.seq.store(index + 1, std::memory_order_release);
+}
+
+static void writeJsonString(std::FILE* f, const char* s) {
+    std::fputc('"', f);
+    for (; *s; ++s) {
+        if (*s == '"' || *s == '\\') std::fputc('\\', f);
+        if (static_cast<unsigned char>(*s) >= 0x20) std::fputc(*s, f);
+    }
+    std::fputc('"', f);
+}
+
+bool Profiler::writeChromeTrace(const std::string& path) const {
+    const uint64_t head = head_.load(std::memory_order_acquire);
+    const uint64_t first = head > mask_ + 1 ? head - (mask_ + 1) : 0;
+    std::vector<Event> events;
+    events.reserve(static_cast<size_t>(head - first));
+    uint32_t threads = 0;
+    for (uint64_t i = first; i < head; ++i) {
+        const Slot& slot = slots_[i & mask_];
+        if (slot.seq.load(std::memory_order_acquire) != i + 1) continue;
+        const Event e = slot.event;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.seq.load(std::memory_order_relaxed) != i + 1) continue;
+        events.push_back(e);
+        if (e.thread + 1 > threads) threads = e.thread + 1;
+    }
+
+    std::FILE* f = std::fopen(path.c_str(), "w");
+    if (!f) {
+        std::cerr << "Cannot write trace file " << path << "\n";
+        return false;
+    }
+    std::fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n", f);
+    // Threads are numbered in the order they first recorded; in the game that makes 0 the main thread.
+    for (uint32_t t = 0; t < threads; ++t)
+        std::fprintf(f, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"thread %u\"}},\n",
+                     t, t);
+    bool firstEvent = true;
+    for (const Event& e : events) {
+        if (!firstEvent) std::fputs(",\n", f);
+        firstEvent = false;
+        std::fputs("{\"name\":", f);
+        writeJsonString(f, e.name);
+        // Chrome trace timestamps are microseconds.
+        std::fprintf(f, ",\"ph\":\"%c\",\"pid\":1,\"tid\":%u,\"ts\":%.3f", e.phase, e.thread, e.startNs / 1e3);
+        if (e.phase == 'X')
+            std::fprintf(f, ",\"dur\":%.3f}", e.value / 1e3);
+        else
+            std::fprintf(f, ",\"args\":{\"value\":%.3f}}", e.value / 1e3);
+    }
+    std::fputs("\n]}\n", f);
+    const bool ok = std::fclose(f) == 0;
+    if (!ok) std::cerr << "Failed writing trace file " << path << "\n";
+    return ok;
+}
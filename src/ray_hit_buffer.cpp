@@ -0,0 +1,30 @@
+/*
+ * Ray hit buffer: all five arrays share one aligned allocation, each starting on its own
+ * cache line.
+ */
+#include "ray_hit_buffer.h"
+#include <new>
+
+void RayHitBuffer::AlignedFree::operator()(uint8_t* p) const {
+    ::operator delete(p, std::align_val_t(64));
+}
+
+static size_t lineBytes(size_t bytes) {
+    return (bytes + 63) & ~size_t(63);
+}
+
+void RayHitBuffer::resize(int columns) {
+    columns_ = columns;
+    if (columns <= capacity_) return;
+
+    const size_t n = static_cast<size_t>(columns);
+    const size_t floats = lineBytes(n * sizeof(float)), bytes = lineBytes(n);
+    storage_.reset(static_cast<uint8_t*>(::operator new(3 * floats + 2 * bytes, std::align_val_t(64))));
+    uint8_t* p = storage_.get();
+    distance_ = reinterpret_cast<float*>(p);
+    height_ = reinterpret_cast<float*>(p + floats);
+    texU_ = reinterpret_cast<float*>(p + 2 * floats);
+    cell_ = p + 3 * floats;
+    side_ = p + 3 * floats + bytes;
+    capacity_ = columns;
+}
@@ -1,38 +1,327 @@
 /*
  * Raycasting renderer (CPU path): one ray per screen column.
- * Casts rays from player position; returns wall height per column for classic 3D projection.
- * Distance-based shading is applied in the main render loop.
+ * Casts rays from player position into a RayHitBuffer: distance, projected wall height,
+ * hit cell, face and texture u per column. Shading is applied in the main render loop.
+ *
+ * Default traversal is a grid DDA (Amanatides & Woo): the ray steps from one cell
+ * boundary to the next, so cost is the number of cells crossed rather than
+ * distance / step size. Rays are spread across a camera plane, which makes the
+ * returned distance perpendicular to the view direction (no fisheye).
+ * The traversal itself lives in raycaster.h so it can run over any grid.
  */
 #include "raycaster.h"
-#include "player.h"
+#include "raycaster_simd.h"
 #include "map.h"
-#include <cmath>
+#include <algorithm>
 
-Raycaster::Raycaster(int screenWidth, int screenHeight)
-    : screenWidth_(screenWidth), screenHeight_(screenHeight) {}
+Raycaster::Raycaster(int screenWidth, int screenHeight, int threads)
+    : screenWidth_(screenWidth), screenHeight_(screenHeight) {
+    setThreadCount(threads);
+}
+
+void Raycaster::setThreadCount(int threads) {
+    pool_.reset();
+    if (threads > 1) pool_ = std::make_unique<ThreadPool>(threads - 1);
+}
 
-std::vector<float> Raycaster::castRays(const Player& player, bool hasKey) {
-    std::vector<float> walls(screenWidth_);
+void Raycaster::setSimdIsa(SimdIsa isa) {
+    isa_ = std::min(isa, detectSimdIsa());
+}
+
+Raycaster::Camera Raycaster::makeCamera(const Player& player) const {
+    Camera cam;
+    cam.originX = static_cast<float>(player.x);
+    cam.originY = static_cast<float>(player.y);
+    cam.dirX = static_cast<float>(std::cos(player.angle));
+    cam.dirY = static_cast<float>(std::sin(player.angle));
+    const float planeScale = std::tan(fov_ / 2.0f);
+    cam.planeX = -cam.dirY * planeScale;
+    cam.planeY =  cam.dirX * planeScale;
+    return cam;
+}
 
-    for (int x = 0; x < screenWidth_; ++x) {
-        float rayAngle = (player.angle - fov_/2.0f) + (x / static_cast<float>(screenWidth_)) * fov_;
-        float distanceToWall = 0.0f;
-        bool hitWall = false;
+long long Raycaster::castPacketColumns(const Camera& cam, const CellGrid& grid, const Target& target,
+                                      RayHitBuffer& out, int begin, int end) const {
+    int lanes = 1;
+#ifdef RAYCASTER_X86_SIMD
+    if (isa_ == SimdIsa::Avx2) lanes = 8;
+    else if (isa_ == SimdIsa::Sse2) lanes = 4;
+#endif
+    alignas(32) float dirX[8];
+    alignas(32) float dirY[8];
+    RayHit hits[8];
+    long long steps = 0;
 
-        double eyeX = std::cos(rayAngle);
-        double eyeY = std::sin(rayAngle);
+    for (int x = begin; x < end; x += lanes) {
+        const int n = std::min(lanes, end - x);
+        // Ray setup is scalar and identical to castColumns(); a short tail packet repeats its last ray.
+        for (int i = 0; i < lanes; ++i) {
+            float cameraX = 2.0f * (x + std::min(i, n - 1)) / static_cast<float>(target.width) - 1.0f;
+            dirX[i] = cam.dirX + cam.planeX * cameraX;
+            dirY[i] = cam.dirY + cam.planeY * cameraX;
+        }
+#ifdef RAYCASTER_X86_SIMD
+        if (lanes == 8) tracePacketAvx2(grid, cam.originX, cam.originY, dirX, dirY, maxDepth_, hits);
+        else if (lanes == 4) tracePacketSse2(grid, cam.originX, cam.originY, dirX, dirY, maxDepth_, hits);
+        else
+#endif
+        hits[0] = castRayDda(cam.originX, cam.originY, dirX[0], dirY[0], grid);
+
+        for (int i = 0; i < n; ++i) {
+            storeHit(out, target, x + i, hits[i], cam.originX, cam.originY, dirX[i], dirY[i]);
+            steps += hits[i].steps;
+        }
+    }
+    return steps;
+}
 
-        while (!hitWall && distanceToWall < maxDepth_) {
-            distanceToWall += 0.05f;
+RayHit Raycaster::castRayField(float originX, float originY, float dirX, float dirY,
+                               const CellGrid& grid, const DistanceField& field) const {
+    RayHit hit;
+    int mapX = static_cast<int>(std::floor(originX));
+    int mapY = static_cast<int>(std::floor(originY));
+    const int stepX = dirX < 0.0f ? -1 : 1;
+    const int stepY = dirY < 0.0f ? -1 : 1;
+    const float deltaX = (dirX == 0.0f) ? 1e30f : std::fabs(1.0f / dirX);
+    const float deltaY = (dirY == 0.0f) ? 1e30f : std::fabs(1.0f / dirY);
 
-            int testX = static_cast<int>(player.x + eyeX * distanceToWall);
-            int testY = static_cast<int>(player.y + eyeY * distanceToWall);
+    // Ray length from the origin to the far x / y boundary of column mx / row my.
+    auto edgeX = [&](int mx) { return dirX == 0.0f ? 1e30f : (stepX > 0 ? mx + 1.0f - originX : originX - mx) * deltaX; };
+    auto edgeY = [&](int my) { return dirY == 0.0f ? 1e30f : (stepY > 0 ? my + 1.0f - originY : originY - my) * deltaY; };
+    float sideDistX = edgeX(mapX);
+    float sideDistY = edgeY(mapY);
 
-            if (Map::isBlocking(testX, testY, hasKey)) hitWall = true;
+    for (;;) {
+        float dist;
+        const int r = field.at(mapX, mapY) - 1;  // Every cell within r (Chebyshev) is open
+        if (r >= 1) {
+            // Leave the open square around the current cell through its nearer far face.
+            const float exitX = edgeX(mapX + stepX * r);
+            const float exitY = edgeY(mapY + stepY * r);
+            if (exitX < exitY) {
+                dist = exitX;
+                int y = static_cast<int>(std::floor(originY + dirY * dist));
+                mapY = std::clamp(y, mapY - r, mapY + r);
+                mapX += stepX * (r + 1);
+                hit.side = 0;
+            } else {
+                dist = exitY;
+                int x = static_cast<int>(std::floor(originX + dirX * dist));
+                mapX = std::clamp(x, mapX - r, mapX + r);
+                mapY += stepY * (r + 1);
+                hit.side = 1;
+            }
+            sideDistX = edgeX(mapX);
+            sideDistY = edgeY(mapY);
+        } else if (sideDistX < sideDistY) {
+            dist = sideDistX;
+            sideDistX += deltaX;
+            mapX += stepX;
+            hit.side = 0;
+        } else {
+            dist = sideDistY;
+            sideDistY += deltaY;
+            mapY += stepY;
+            hit.side = 1;
+        }
+        if (dist >= maxDepth_) {
+            hit.distance = maxDepth_;
+            return hit;
+        }
+        ++hit.steps;
+        int cell = grid(mapX, mapY);
+        if (cell) {
+            hit.distance = dist;
+            hit.cell = cell;
+            return hit;
+        }
+    }
+}
+
+RayHit Raycaster::castRayPyramid(float originX, float originY, float dirX, float dirY,
+                                 const CellGrid& grid, const PyramidGrid& pyramid) const {
+    RayHit hit;
+    int mapX = static_cast<int>(std::floor(originX));
+    int mapY = static_cast<int>(std::floor(originY));
+    const int stepX = dirX < 0.0f ? -1 : 1;
+    const int stepY = dirY < 0.0f ? -1 : 1;
+    const float deltaX = (dirX == 0.0f) ? 1e30f : std::fabs(1.0f / dirX);
+    const float deltaY = (dirY == 0.0f) ? 1e30f : std::fabs(1.0f / dirY);
+
+    auto edgeX = [&](int mx) { return dirX == 0.0f ? 1e30f : (stepX > 0 ? mx + 1.0f - originX : originX - mx) * deltaX; };
+    auto edgeY = [&](int my) { return dirY == 0.0f ? 1e30f : (stepY > 0 ? my + 1.0f - originY : originY - my) * deltaY; };
+    float sideDistX = edgeX(mapX);
+    float sideDistY = edgeY(mapY);
+
+    int level = 0;
+    for (;;) {
+        float dist;
+        if (grid.inside(mapX, mapY)) {
+            level = std::min(level + 1, pyramid.levels - 1);
+            while (level > 0 && pyramid.occupied(grid, level, mapX, mapY)) --level;
+        } else {
+            level = 0;  // Only reachable from the origin cell
+        }
+        if (level > 0) {
+            // Leave the empty block [x0, x0 + size) x [y0, y0 + size) through its nearer far face.
+            const int size = 1 << level;
+            const int x0 = mapX & ~(size - 1), y0 = mapY & ~(size - 1);
+            const float exitX = edgeX(stepX > 0 ? x0 + size - 1 : x0);
+            const float exitY = edgeY(stepY > 0 ? y0 + size - 1 : y0);
+            if (exitX < exitY) {
+                dist = exitX;
+                int y = static_cast<int>(std::floor(originY + dirY * dist));
+                mapY = std::clamp(y, y0, y0 + size - 1);
+                mapX = stepX > 0 ? x0 + size : x0 - 1;
+                hit.side = 0;
+            } else {
+                dist = exitY;
+                int x = static_cast<int>(std::floor(originX + dirX * dist));
+                mapX = std::clamp(x, x0, x0 + size - 1);
+                mapY = stepY > 0 ? y0 + size : y0 - 1;
+                hit.side = 1;
+            }
+            sideDistX = edgeX(mapX);
+            sideDistY = edgeY(mapY);
+        } else if (sideDistX < sideDistY) {
+            dist = sideDistX;
+            sideDistX += deltaX;
+            mapX += stepX;
+            hit.side = 0;
+        } else {
+            dist = sideDistY;
+            sideDistY += deltaY;
+            mapY += stepY;
+            hit.side = 1;
+        }
+        if (dist >= maxDepth_) {
+            hit.distance = maxDepth_;
+            return hit;
         }
+        ++hit.steps;
+        int cell = grid(mapX, mapY);
+        if (cell) {
+            hit.distance = dist;
+            hit.cell = cell;
+            return hit;
+        }
+    }
+}
+
+long long Raycaster::castFieldColumns(const Camera& cam, const CellGrid& grid, const DistanceField& field,
+                                      const Target& target, RayHitBuffer& hits, int begin, int end) const {
+    long long steps = 0;
+    for (int x = begin; x < end; ++x) {
+        float cameraX = 2.0f * x / static_cast<float>(target.width) - 1.0f;
+        const float dirX = cam.dirX + cam.planeX * cameraX, dirY = cam.dirY + cam.planeY * cameraX;
+        RayHit hit = castRayField(cam.originX, cam.originY, dirX, dirY, grid, field);
+        storeHit(hits, target, x, hit, cam.originX, cam.originY, dirX, dirY);
+        steps += hit.steps;
+    }
+    return steps;
+}
 
-        walls[x] = (screenHeight_ / (distanceToWall + 0.0001f)) * 2.0f;
+long long Raycaster::castPyramidColumns(const Camera& cam, const CellGrid& grid, const PyramidGrid& pyramid,
+                                        const Target& target, RayHitBuffer& hits, int begin, int end) const {
+    long long steps = 0;
+    for (int x = begin; x < end; ++x) {
+        float cameraX = 2.0f * x / static_cast<float>(target.width) - 1.0f;
+        const float dirX = cam.dirX + cam.planeX * cameraX, dirY = cam.dirY + cam.planeY * cameraX;
+        RayHit hit = castRayPyramid(cam.originX, cam.originY, dirX, dirY, grid, pyramid);
+        storeHit(hits, target, x, hit, cam.originX, cam.originY, dirX, dirY);
+        steps += hit.steps;
     }
+    return steps;
+}
+
+long long Raycaster::castFrame(const Player& player, const CellGrid& grid, RayHitBuffer& hits,
+                               const DistanceField* field, const PyramidGrid* pyramid) const {
+    const bool useField = mode_ == Mode::Field && field && field->width() == grid.width &&
+                          field->height() == grid.height;
+    const bool usePyramid = mode_ == Mode::Pyramid && pyramid && pyramid->levels > 0;
+    if (mode_ != Mode::Packet && !useField && !usePyramid) return castFrame<CellGrid>(player, grid, hits);
+
+    hits.resize(screenWidth_);
+    const Camera cam = makeCamera(player);
+    const Target target = screenTarget();
+    auto cast = [&](int begin, int end) {
+        if (useField) return castFieldColumns(cam, grid, *field, target, hits, begin, end);
+        if (usePyramid) return castPyramidColumns(cam, grid, *pyramid, target, hits, begin, end);
+        return castPacketColumns(cam, grid, target, hits, begin, end);
+    };
+    if (!pool_) return cast(0, screenWidth_);
+
+    std::atomic<long long> steps{0};
+    pool_->parallelFor(screenWidth_, kColumnTile, [&](int begin, int end) {
+        steps.fetch_add(cast(begin, end), std::memory_order_relaxed);
+    });
+    return steps.load();
+}
+
+long long Raycaster::castRays(const Player& player, const Map& map, bool hasKey, RayHitBuffer& hits) const {
+    const DistanceField& field = map.distanceField();
+    const PyramidGrid pyramid = map.occupancyPyramid().grid(hasKey);
+    return castFrame(player, map.tiles().grid(hasKey), hits,
+                     !field.empty() && field.hasKey() == hasKey ? &field : nullptr,
+                     pyramid.levels > 0 ? &pyramid : nullptr);
+}
+
+int Raycaster::layoutViews(View* views, int count) {
+    int column = 0;
+    for (int i = 0; i < count; ++i) {
+        views[i].column = column;
+        column += std::max(views[i].width, 0);
+    }
+    return column;
+}
+
+long long Raycaster::castViews(const View* views, int count, const Map& map, RayHitBuffer& atlas) const {
+    int columns = 0, maxTiles = 0;
+    for (int i = 0; i < count; ++i) {
+        columns = std::max(columns, views[i].column + views[i].width);
+        maxTiles = std::max(maxTiles, (views[i].width + kColumnTile - 1) / kColumnTile);
+    }
+    if (atlas.columns() < columns) atlas.resize(columns);
+    if (maxTiles == 0) return 0;
+
+    // Shared by every view: the map, its field (for the key state it was built for) and the
+    // pyramid grids of both key states.
+    const DistanceField& field = map.distanceField();
+    const bool fieldReady = mode_ == Mode::Field && !field.empty() && field.width() == map.width() &&
+                            field.height() == map.height();
+    const PyramidGrid pyramids[2] = {map.occupancyPyramid().grid(false), map.occupancyPyramid().grid(true)};
+    const CellGrid grids[2] = {map.tiles().grid(false), map.tiles().grid(true)};
+
+    // Work item i is column tile i % maxTiles of view i / maxTiles (empty past the view's
+    // width), so one parallelFor covers every view with no index table, and each participant's
+    // contiguous run of items stays within one view's neighbouring columns.
+    auto cast = [&](int begin, int end) {
+        long long steps = 0;
+        for (int item = begin; item < end; ++item) {
+            const View& view = views[item / maxTiles];
+            const int first = (item % maxTiles) * kColumnTile;
+            const int last = std::min(first + kColumnTile, view.width);
+            if (first >= last) continue;
+            const Camera cam = makeCamera(view.pose);
+            const Target target{view.width, view.height, view.column};
+            const CellGrid& grid = grids[view.hasKey];
+            const PyramidGrid& pyramid = pyramids[view.hasKey];
+            if (fieldReady && field.hasKey() == view.hasKey)
+                steps += castFieldColumns(cam, grid, field, target, atlas, first, last);
+            else if (mode_ == Mode::Pyramid && pyramid.levels > 0)
+                steps += castPyramidColumns(cam, grid, pyramid, target, atlas, first, last);
+            else if (mode_ == Mode::Packet)
+                steps += castPacketColumns(cam, grid, target, atlas, first, last);
+            else
+                steps += castColumns(view.pose, cam, grid, target, atlas, first, last);
+        }
+        return steps;
+    };
+    if (!pool_) return cast(0, count * maxTiles);
 
-    return walls;
+    std::atomic<long long> steps{0};
+    pool_->parallelFor(count * maxTiles, 1, [&](int begin, int end) {
+        steps.fetch_add(cast(begin, end), std::memory_order_relaxed);
+    });
+    return steps.load();
 }
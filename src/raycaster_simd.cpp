@@ -0,0 +1,244 @@
+/*
+ * SIMD packet kernels for the CPU raycaster, plus runtime ISA detection.
+ * The AVX2 kernel is compiled with a per-function target attribute, so the rest of the
+ * program keeps the baseline ISA and the kernel is only entered after a CPUID check.
+ */
+#include "raycaster_simd.h"
+#include <cmath>
+
+#ifdef RAYCASTER_X86_SIMD
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define RAYCASTER_TARGET_AVX2
+#else
+#define RAYCASTER_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+const char* simdIsaName(SimdIsa isa) {
+    switch (isa) {
+        case SimdIsa::Avx2: return "avx2";
+        case SimdIsa::Sse2: return "sse2";
+        default: return "scalar";
+    }
+}
+
+SimdIsa detectSimdIsa() {
+#ifdef RAYCASTER_X86_SIMD
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 0);
+    const int maxLeaf = info[0];
+    __cpuid(info, 1);
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    const bool avx = (info[2] & (1 << 28)) != 0;
+    const bool sse2 = (info[3] & (1 << 26)) != 0;
+    bool avx2 = false;
+    if (maxLeaf >= 7 && osxsave && avx && (_xgetbv(0) & 0x6) == 0x6) {
+        __cpuidex(info, 7, 0);
+        avx2 = (info[1] & (1 << 5)) != 0;
+    }
+    if (avx2) return SimdIsa::Avx2;
+    if (sse2) return SimdIsa::Sse2;
+#else
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return SimdIsa::Avx2;
+    if (__builtin_cpu_supports("sse2")) return SimdIsa::Sse2;
+#endif
+#endif
+    return SimdIsa::Scalar;
+}
+
+#ifdef RAYCASTER_X86_SIMD
+
+void tracePacketSse2(const CellGrid& grid, float originX, float originY,
+                     const float* dirX, const float* dirY, float maxDepth, RayHit* out) {
+    const int mapX0 = static_cast<int>(std::floor(originX));
+    const int mapY0 = static_cast<int>(std::floor(originY));
+    const __m128 ox = _mm_set1_ps(originX), oy = _mm_set1_ps(originY);
+    const __m128 fmx = _mm_set1_ps(static_cast<float>(mapX0)), fmy = _mm_set1_ps(static_cast<float>(mapY0));
+    const __m128 one = _mm_set1_ps(1.0f), big = _mm_set1_ps(1e30f), zero = _mm_setzero_ps();
+    const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+    const __m128 depth = _mm_set1_ps(maxDepth);
+
+    const __m128 dx = _mm_loadu_ps(dirX), dy = _mm_loadu_ps(dirY);
+    auto select = [](__m128 m, __m128 a, __m128 b) { return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b)); };
+    auto selecti = [](__m128i m, __m128i a, __m128i b) { return _mm_or_si128(_mm_and_si128(m, a), _mm_andnot_si128(m, b)); };
+
+    const __m128 deltaX = select(_mm_cmpeq_ps(dx, zero), big, _mm_and_ps(_mm_div_ps(one, dx), absMask));
+    const __m128 deltaY = select(_mm_cmpeq_ps(dy, zero), big, _mm_and_ps(_mm_div_ps(one, dy), absMask));
+    const __m128 negX = _mm_cmplt_ps(dx, zero), negY = _mm_cmplt_ps(dy, zero);
+    __m128 sideDistX = select(negX, _mm_mul_ps(_mm_sub_ps(ox, fmx), deltaX),
+                              _mm_mul_ps(_mm_sub_ps(_mm_add_ps(fmx, one), ox), deltaX));
+    __m128 sideDistY = select(negY, _mm_mul_ps(_mm_sub_ps(oy, fmy), deltaY),
+                              _mm_mul_ps(_mm_sub_ps(_mm_add_ps(fmy, one), oy), deltaY));
+    const __m128i onei = _mm_set1_epi32(1);
+    const __m128i stepX = _mm_or_si128(_mm_castps_si128(negX), onei);  // -1 or 1
+    const __m128i stepY = _mm_or_si128(_mm_castps_si128(negY), onei);
+    __m128i mapX = _mm_set1_epi32(mapX0), mapY = _mm_set1_epi32(mapY0);
+
+    __m128i active = _mm_set1_epi32(-1);
+    __m128 outDist = zero;
+    __m128i outSide = _mm_setzero_si128(), steps = _mm_setzero_si128();
+    __m128i hitX = _mm_setzero_si128(), hitY = _mm_setzero_si128(), hitAny = _mm_setzero_si128();
+    const __m128i tilesX = _mm_set1_epi32(grid.tilesX), seven = _mm_set1_epi32(7);
+    const __m128i width = _mm_set1_epi32(grid.width), height = _mm_set1_epi32(grid.height);
+    const __m128i minusOne = _mm_set1_epi32(-1);
+    alignas(16) int tile[4], bit[4];
+
+    while (_mm_movemask_ps(_mm_castsi128_ps(active))) {
+        const __m128 takeX = _mm_cmplt_ps(sideDistX, sideDistY);
+        const __m128i takeXi = _mm_castps_si128(takeX);
+        const __m128 dist = select(takeX, sideDistX, sideDistY);
+        sideDistX = _mm_add_ps(sideDistX, _mm_and_ps(takeX, deltaX));
+        sideDistY = _mm_add_ps(sideDistY, _mm_andnot_ps(takeX, deltaY));
+        mapX = _mm_add_epi32(mapX, _mm_and_si128(takeXi, stepX));
+        mapY = _mm_add_epi32(mapY, _mm_andnot_si128(takeXi, stepY));
+        const __m128i side = _mm_andnot_si128(takeXi, onei);
+
+        // Lanes that ran past maxDepth finish with no hit.
+        const __m128i far = _mm_and_si128(_mm_castps_si128(_mm_cmpge_ps(dist, depth)), active);
+        outDist = select(_mm_castsi128_ps(far), depth, outDist);
+        outSide = selecti(far, side, outSide);
+        active = _mm_andnot_si128(far, active);
+        steps = _mm_add_epi32(steps, _mm_and_si128(active, onei));
+
+        // No gather or variable shift in SSE2: build tile / bit indices in vector registers,
+        // then four scalar bitplane tests. Out-of-bounds lanes read tile 0 and are forced to stop.
+        const __m128i inside = _mm_and_si128(
+            _mm_and_si128(_mm_cmpgt_epi32(mapX, minusOne), _mm_cmplt_epi32(mapX, width)),
+            _mm_and_si128(_mm_cmpgt_epi32(mapY, minusOne), _mm_cmplt_epi32(mapY, height)));
+        const __m128i tileY = _mm_srai_epi32(mapY, 3);
+        const __m128i rowEven = _mm_mul_epu32(tileY, tilesX);  // lanes 0, 2 (low 32 bits)
+        const __m128i rowOdd = _mm_mul_epu32(_mm_srli_si128(tileY, 4), tilesX);  // lanes 1, 3
+        const __m128i row = _mm_unpacklo_epi32(_mm_shuffle_epi32(rowEven, _MM_SHUFFLE(0, 0, 2, 0)),
+                                               _mm_shuffle_epi32(rowOdd, _MM_SHUFFLE(0, 0, 2, 0)));
+        _mm_store_si128(reinterpret_cast<__m128i*>(tile),
+                        _mm_and_si128(_mm_add_epi32(row, _mm_srai_epi32(mapX, 3)), inside));
+        _mm_store_si128(reinterpret_cast<__m128i*>(bit),
+                        _mm_or_si128(_mm_slli_epi32(_mm_and_si128(mapY, seven), 3), _mm_and_si128(mapX, seven)));
+        const __m128i solid = _mm_setr_epi32(static_cast<int>(grid.blocking[tile[0]] >> bit[0]) & 1,
+                                             static_cast<int>(grid.blocking[tile[1]] >> bit[1]) & 1,
+                                             static_cast<int>(grid.blocking[tile[2]] >> bit[2]) & 1,
+                                             static_cast<int>(grid.blocking[tile[3]] >> bit[3]) & 1);
+        const __m128i stop = _mm_or_si128(_mm_cmpeq_epi32(solid, onei), _mm_andnot_si128(inside, minusOne));
+        const __m128i hit = _mm_and_si128(stop, active);
+        outDist = select(_mm_castsi128_ps(hit), dist, outDist);
+        outSide = selecti(hit, side, outSide);
+        hitX = selecti(hit, mapX, hitX);
+        hitY = selecti(hit, mapY, hitY);
+        hitAny = _mm_or_si128(hitAny, hit);
+        active = _mm_andnot_si128(hit, active);
+    }
+
+    alignas(16) float d[4];
+    alignas(16) int sd[4], st[4], hx[4], hy[4], h[4];
+    _mm_store_ps(d, outDist);
+    _mm_store_si128(reinterpret_cast<__m128i*>(sd), outSide);
+    _mm_store_si128(reinterpret_cast<__m128i*>(st), steps);
+    _mm_store_si128(reinterpret_cast<__m128i*>(hx), hitX);
+    _mm_store_si128(reinterpret_cast<__m128i*>(hy), hitY);
+    _mm_store_si128(reinterpret_cast<__m128i*>(h), hitAny);
+    for (int i = 0; i < 4; ++i) {
+        out[i].distance = d[i];
+        out[i].side = sd[i];
+        out[i].cell = h[i] ? grid.cell(hx[i], hy[i]) : Cell::Empty;  // One cell byte per ray
+        out[i].steps = st[i];
+    }
+}
+
+RAYCASTER_TARGET_AVX2
+void tracePacketAvx2(const CellGrid& grid, float originX, float originY,
+                     const float* dirX, const float* dirY, float maxDepth, RayHit* out) {
+    const int mapX0 = static_cast<int>(std::floor(originX));
+    const int mapY0 = static_cast<int>(std::floor(originY));
+    const __m256 ox = _mm256_set1_ps(originX), oy = _mm256_set1_ps(originY);
+    const __m256 fmx = _mm256_set1_ps(static_cast<float>(mapX0)), fmy = _mm256_set1_ps(static_cast<float>(mapY0));
+    const __m256 one = _mm256_set1_ps(1.0f), big = _mm256_set1_ps(1e30f), zero = _mm256_setzero_ps();
+    const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+    const __m256 depth = _mm256_set1_ps(maxDepth);
+
+    const __m256 dx = _mm256_loadu_ps(dirX), dy = _mm256_loadu_ps(dirY);
+    const __m256 deltaX = _mm256_blendv_ps(_mm256_and_ps(_mm256_div_ps(one, dx), absMask), big,
+                                           _mm256_cmp_ps(dx, zero, _CMP_EQ_OQ));
+    const __m256 deltaY = _mm256_blendv_ps(_mm256_and_ps(_mm256_div_ps(one, dy), absMask), big,
+                                           _mm256_cmp_ps(dy, zero, _CMP_EQ_OQ));
+    const __m256 negX = _mm256_cmp_ps(dx, zero, _CMP_LT_OQ), negY = _mm256_cmp_ps(dy, zero, _CMP_LT_OQ);
+    __m256 sideDistX = _mm256_blendv_ps(_mm256_mul_ps(_mm256_sub_ps(_mm256_add_ps(fmx, one), ox), deltaX),
+                                        _mm256_mul_ps(_mm256_sub_ps(ox, fmx), deltaX), negX);
+    __m256 sideDistY = _mm256_blendv_ps(_mm256_mul_ps(_mm256_sub_ps(_mm256_add_ps(fmy, one), oy), deltaY),
+                                        _mm256_mul_ps(_mm256_sub_ps(oy, fmy), deltaY), negY);
+    const __m256i onei = _mm256_set1_epi32(1);
+    const __m256i stepX = _mm256_or_si256(_mm256_castps_si256(negX), onei);  // -1 or 1
+    const __m256i stepY = _mm256_or_si256(_mm256_castps_si256(negY), onei);
+    __m256i mapX = _mm256_set1_epi32(mapX0), mapY = _mm256_set1_epi32(mapY0);
+
+    __m256i active = _mm256_set1_epi32(-1);
+    __m256 outDist = zero;
+    __m256i outSide = _mm256_setzero_si256(), steps = _mm256_setzero_si256();
+    __m256i hitX = _mm256_setzero_si256(), hitY = _mm256_setzero_si256(), hitAny = _mm256_setzero_si256();
+    const __m256i tilesX = _mm256_set1_epi32(grid.tilesX), seven = _mm256_set1_epi32(7);
+    const __m256i thirtyOne = _mm256_set1_epi32(31);
+    const int* planeWords = reinterpret_cast<const int*>(grid.blocking);
+    const __m256i width = _mm256_set1_epi32(grid.width), height = _mm256_set1_epi32(grid.height);
+    const __m256i minusOne = _mm256_set1_epi32(-1);
+
+    while (!_mm256_testz_si256(active, active)) {
+        const __m256 takeX = _mm256_cmp_ps(sideDistX, sideDistY, _CMP_LT_OQ);
+        const __m256i takeXi = _mm256_castps_si256(takeX);
+        const __m256 dist = _mm256_blendv_ps(sideDistY, sideDistX, takeX);
+        sideDistX = _mm256_add_ps(sideDistX, _mm256_and_ps(takeX, deltaX));
+        sideDistY = _mm256_add_ps(sideDistY, _mm256_andnot_ps(takeX, deltaY));
+        mapX = _mm256_add_epi32(mapX, _mm256_and_si256(takeXi, stepX));
+        mapY = _mm256_add_epi32(mapY, _mm256_andnot_si256(takeXi, stepY));
+        const __m256i side = _mm256_andnot_si256(takeXi, onei);
+
+        // Lanes that ran past maxDepth finish with no hit.
+        const __m256i far = _mm256_and_si256(_mm256_castps_si256(_mm256_cmp_ps(dist, depth, _CMP_GE_OQ)), active);
+        outDist = _mm256_blendv_ps(outDist, depth, _mm256_castsi256_ps(far));
+        outSide = _mm256_blendv_epi8(outSide, side, far);
+        active = _mm256_andnot_si256(far, active);
+        steps = _mm256_add_epi32(steps, _mm256_and_si256(active, onei));
+
+        // Gather the 32-bit half of each live, in-bounds lane's tile bitplane word that holds its
+        // bit (little-endian), then one variable shift. Out-of-bounds lanes stop as Wall.
+        const __m256i inside = _mm256_and_si256(
+            _mm256_and_si256(_mm256_cmpgt_epi32(mapX, minusOne), _mm256_cmpgt_epi32(width, mapX)),
+            _mm256_and_si256(_mm256_cmpgt_epi32(mapY, minusOne), _mm256_cmpgt_epi32(height, mapY)));
+        const __m256i load = _mm256_and_si256(inside, active);
+        const __m256i tile = _mm256_add_epi32(_mm256_mullo_epi32(_mm256_srai_epi32(mapY, 3), tilesX),
+                                              _mm256_srai_epi32(mapX, 3));
+        const __m256i bit = _mm256_or_si256(_mm256_slli_epi32(_mm256_and_si256(mapY, seven), 3),
+                                            _mm256_and_si256(mapX, seven));
+        const __m256i word = _mm256_add_epi32(_mm256_slli_epi32(tile, 1), _mm256_srli_epi32(bit, 5));
+        const __m256i plane = _mm256_mask_i32gather_epi32(_mm256_setzero_si256(), planeWords, word, load, 4);
+        const __m256i solid = _mm256_and_si256(_mm256_srlv_epi32(plane, _mm256_and_si256(bit, thirtyOne)), onei);
+
+        const __m256i stop = _mm256_or_si256(_mm256_cmpeq_epi32(solid, onei), _mm256_andnot_si256(inside, minusOne));
+        const __m256i hit = _mm256_and_si256(stop, active);
+        outDist = _mm256_blendv_ps(outDist, dist, _mm256_castsi256_ps(hit));
+        outSide = _mm256_blendv_epi8(outSide, side, hit);
+        hitX = _mm256_blendv_epi8(hitX, mapX, hit);
+        hitY = _mm256_blendv_epi8(hitY, mapY, hit);
+        hitAny = _mm256_or_si256(hitAny, hit);
+        active = _mm256_andnot_si256(hit, active);
+    }
+
+    alignas(32) float d[8];
+    alignas(32) int sd[8], st[8], hx[8], hy[8], h[8];
+    _mm256_store_ps(d, outDist);
+    _mm256_store_si256(reinterpret_cast<__m256i*>(sd), outSide);
+    _mm256_store_si256(reinterpret_cast<__m256i*>(st), steps);
+    _mm256_store_si256(reinterpret_cast<__m256i*>(hx), hitX);
+    _mm256_store_si256(reinterpret_cast<__m256i*>(hy), hitY);
+    _mm256_store_si256(reinterpret_cast<__m256i*>(h), hitAny);
+    for (int i = 0; i < 8; ++i) {
+        out[i].distance = d[i];
+        out[i].side = sd[i];
+        out[i].cell = h[i] ? grid.cell(hx[i], hy[i]) : Cell::Empty;  // One cell byte per ray
+        out[i].steps = st[i];
+    }
+}
+
+#endif // RAYCASTER_X86_SIMD
@@ -0,0 +1,57 @@
+#include "render_scale.h"
+#include <algorithm>
+#include <cmath>
+
+void RenderScale::setFixed(double scale) {
+    adaptive_ = false;
+    change(std::clamp(scale, 0.1, 1.0));
+}
+
+void RenderScale::setAdaptive() {
+    adaptive_ = true;
+    change(config_.maxScale);
+}
+
+int RenderScale::scaled(int size) const {
+    return std::max(1, static_cast<int>(size * scale_ + 0.5));
+}
+
+double RenderScale::mean(int frames) const {
+    frames = std::min(frames, kHistory);
+    if (frames <= 0) return 0.0;
+    double sum = 0.0;
+    for (int i = 1; i <= frames; ++i) sum += history_[(next_ - i + kHistory) % kHistory];
+    return sum / frames;
+}
+
+void RenderScale::change(double scale) {
+    scale_ = scale;
+    count_ = -config_.settleFrames;
+}
+
+bool RenderScale::update(double workMs) {
+    if (!adaptive_ || budgetMs_ <= 0.0) return false;
+    if (count_++ < 0) return false;  // Still settling after the last change
+    history_[next_] = static_cast<float>(workMs);
+    next_ = (next_ + 1) % kHistory;
+
+    if (count_ >= config_.downFrames && scale_ > config_.minScale) {
+        const double ms = mean(config_.downFrames);
+        if (ms > config_.highWater * budgetMs_) {
+            // Aim between the water marks, at least one step down.
+            const double target = 0.5 * (config_.highWater + config_.lowWater) * budgetMs_;
+            const double scale = std::min(scale_ - config_.step, scale_ * std::sqrt(target / ms));
+            change(std::max(scale, config_.minScale));
+            return true;
+        }
+    }
+    if (count_ >= config_.upFrames && scale_ < config_.maxScale) {
+        const double scale = std::min(scale_ + config_.step, config_.maxScale);
+        const double predicted = mean(config_.upFrames) * (scale * scale) / (scale_ * scale_);
+        if (predicted < config_.lowWater * budgetMs_) {
+            change(scale);
+            return true;
+        }
+    }
+    return false;
+}
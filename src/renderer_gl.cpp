@@ -3,12 +3,14 @@
 #include "map.h"
 #include "gl_core.h"
 #include <SDL2/SDL.h>
+#include <algorithm>
 #include <cmath>
 #include <cstring>
 #include <fstream>
 #include <iostream>
 #include <sstream>
 #include <string>
+#include <vector>
 
 namespace {
 
@@ -22,63 +24,140 @@ void main() {
 }
 )";
 
-const char* kFragSource = R"(
+// Pass 1, drawn into two columns x 1 targets: one exact DDA per screen column against the map
+// texture (texel (x, y) = cell (x, y)), jumping open space with the distance field. Outputs
+// per column: the hit (perpendicular distance, cell type, side, texture u) and the lit wall
+// color with half the wall's height in pixels.
+const char* kCastFrag = R"(
 #version 330 core
-in vec2 vUV;
-out vec4 fragColor;
+layout(location = 0) out vec4 hit;
+layout(location = 1) out vec4 column;
 uniform vec2 uPlayerPos;
-uniform float uPlayerAngle;
-uniform float uFov;
-uniform vec2 uMapSize;
+uniform vec2 uCamDir;
+uniform vec2 uCamPlane;
+uniform float uColumns;
+uniform float uMaxDepth;
 uniform float uHasKey;
-uniform vec2 uResolution;
+uniform float uUseField;
+uniform float uFocal;
 uniform sampler2D uMapTex;
-const float MAX_DEPTH = 20.0;
+uniform sampler2D uFieldTex;
 const float FOG_DIST = 12.0;
-const float C_EMPTY = 0.0;
 const float C_WALL  = 1.0;
 const float C_DOOR  = 2.0;
 const float C_KEY   = 3.0;
 const float C_EXIT  = 4.0;
-float sampleMap(vec2 p) {
-    vec2 uv = vec2((p.x + 0.5) / uMapSize.x, 1.0 - (p.y + 0.5) / uMapSize.y);
-    return texture(uMapTex, uv).r * 255.0;
+ivec2 mapSize;
+ivec2 stepDir;
+vec2 delta;
+bvec2 still;
+// Ray length to the far x / y boundary of column / row c.
+vec2 edgeDist(ivec2 c) {
+    vec2 toEdge = mix(uPlayerPos - vec2(c), vec2(c) + 1.0 - uPlayerPos, greaterThan(stepDir, ivec2(0)));
+    return mix(toEdge * delta, vec2(1e30), still);
+}
+float cellAt(ivec2 c) {
+    if (any(lessThan(c, ivec2(0))) || any(greaterThanEqual(c, mapSize))) return C_WALL;
+    return texelFetch(uMapTex, c, 0).r * 255.0;
+}
+bool stopsRay(float cellType) {
+    return cellType > 0.5 && !(uHasKey > 0.5 && abs(cellType - C_DOOR) < 0.5);
 }
 void main() {
-    float aspect = uResolution.x / uResolution.y;
-    float rayAngle = uPlayerAngle - uFov * 0.5 + (vUV.x * uFov);
-    vec2 dir = vec2(cos(rayAngle), sin(rayAngle));
-    float dist = 0.0;
-    float cellType = C_EMPTY;
-    float stepSize = 0.04;
-    for (int i = 0; i < 400; i++) {
-        dist += stepSize;
-        vec2 pos = uPlayerPos + dir * dist;
-        vec2 cell = floor(pos);
-        cellType = sampleMap(cell);
-        if (cellType >= C_WALL) break;
-    }
-    if (cellType < C_WALL) {
-        vec3 ceilingCol = vec3(70.0/255.0, 130.0/255.0, 180.0/255.0);
-        vec3 floorCol = vec3(50.0/255.0, 50.0/255.0, 50.0/255.0);
-        vec3 col = mix(floorCol, ceilingCol, step(0.5, vUV.y));
-        fragColor = vec4(col, 1.0);
-        return;
+    mapSize = textureSize(uMapTex, 0);
+    float cameraX = 2.0 * floor(gl_FragCoord.x) / uColumns - 1.0;
+    vec2 dir = uCamDir + uCamPlane * cameraX;
+    ivec2 cell = ivec2(floor(uPlayerPos));
+    stepDir = ivec2(dir.x < 0.0 ? -1 : 1, dir.y < 0.0 ? -1 : 1);
+    still = equal(dir, vec2(0.0));
+    delta = abs(1.0 / mix(dir, vec2(1.0), still));
+    vec2 sideDist = edgeDist(cell);
+    float dist = uMaxDepth;
+    float cellType = 0.0;
+    float side = 0.0;
+    for (int i = 0; i < 256; i++) {
+        float d;
+        float s;
+        int r = 0;
+        if (uUseField > 0.5 && all(greaterThanEqual(cell, ivec2(0))) && all(lessThan(cell, mapSize)))
+            r = int(texelFetch(uFieldTex, cell, 0).r * 255.0 + 0.5) - 1;
+        if (r >= 1) {
+            // Leave the open square around the cell in one jump (see Raycaster::castRayField).
+            vec2 exitDist = edgeDist(cell + stepDir * r);
+            if (exitDist.x < exitDist.y) {
+                d = exitDist.x;
+                cell.y = clamp(int(floor(uPlayerPos.y + dir.y * d)), cell.y - r, cell.y + r);
+                cell.x += stepDir.x * (r + 1);
+                s = 0.0;
+            } else {
+                d = exitDist.y;
+                cell.x = clamp(int(floor(uPlayerPos.x + dir.x * d)), cell.x - r, cell.x + r);
+                cell.y += stepDir.y * (r + 1);
+                s = 1.0;
+            }
+            sideDist = edgeDist(cell);
+        } else if (sideDist.x < sideDist.y) {
+            d = sideDist.x;
+            sideDist.x += delta.x;
+            cell.x += stepDir.x;
+            s = 0.0;
+        } else {
+            d = sideDist.y;
+            sideDist.y += delta.y;
+            cell.y += stepDir.y;
+            s = 1.0;
+        }
+        if (d >= uMaxDepth) break;
+        float c = cellAt(cell);
+        if (stopsRay(c)) {
+            dist = d;
+            cellType = c;
+            side = s;
+            break;
+        }
     }
+    float along = side < 0.5 ? uPlayerPos.y + dist * dir.y : uPlayerPos.x + dist * dir.x;
+    float u = fract(along);
+    if ((side < 0.5 && dir.x > 0.0) || (side > 0.5 && dir.y < 0.0)) u = 1.0 - u;
+    hit = vec4(dist, cellType, side, u);
+
+    // Everything the shading pass needs per column: lit wall color and half its height in pixels.
     vec3 wallCol;
     if (cellType >= C_EXIT - 0.5)
         wallCol = vec3(0.2, 0.6, 0.25);
     else if (cellType >= C_KEY - 0.5)
         wallCol = vec3(0.85, 0.7, 0.2);
     else if (cellType >= C_DOOR - 0.5)
-        wallCol = uHasKey > 0.5 ? vec3(0.25, 0.2, 0.15) : vec3(0.35, 0.25, 0.15);
+        wallCol = vec3(0.35, 0.25, 0.15);
     else
         wallCol = vec3(0.4, 0.35, 0.3);
-    float shade = 1.0 - (dist / MAX_DEPTH) * 0.5;
+    float shade = 1.0 - (dist / uMaxDepth) * 0.5;
+    if (side > 0.5) shade *= 0.8;
     wallCol *= shade;
     float fog = 1.0 - exp(-dist / FOG_DIST);
     wallCol = mix(wallCol, vec3(0.35, 0.38, 0.4), fog);
-    fragColor = vec4(wallCol, 1.0);
+    column = vec4(wallCol, cellType > 0.5 ? 0.5 * uFocal / max(dist, 1e-4) : -1.0);
+}
+)";
+
+// Pass 2, full screen: one texel fetch and compare per pixel; no traversal, no lighting.
+const char* kShadeFrag = R"(
+#version 330 core
+in vec2 vUV;
+out vec4 fragColor;
+uniform vec2 uResolution;
+uniform sampler2D uColumnTex;
+void main() {
+    int columns = textureSize(uColumnTex, 0).x;
+    int column = min(int(gl_FragCoord.x * float(columns) / uResolution.x), columns - 1);
+    vec4 wall = texelFetch(uColumnTex, ivec2(column, 0), 0);
+    if (abs(gl_FragCoord.y - 0.5 * uResolution.y) <= wall.a) {
+        fragColor = vec4(wall.rgb, 1.0);
+        return;
+    }
+    vec3 ceilingCol = vec3(70.0/255.0, 130.0/255.0, 180.0/255.0);
+    vec3 floorCol = vec3(50.0/255.0, 50.0/255.0, 50.0/255.0);
+    fragColor = vec4(mix(floorCol, ceilingCol, step(0.5, vUV.y)), 1.0);
 }
 )";
 
@@ -102,7 +181,7 @@ uniform vec2 uMapSize;
 uniform float uHasKey;
 uniform sampler2D uMapTex;
 float sampleMap(vec2 p) {
-    vec2 uv = vec2((p.x + 0.5) / uMapSize.x, 1.0 - (p.y + 0.5) / uMapSize.y);
+    vec2 uv = vec2((p.x + 0.5) / uMapSize.x, (p.y + 0.5) / uMapSize.y);
     return texture(uMapTex, uv).r * 255.0;
 }
 void main() {
@@ -119,6 +198,9 @@ void main() {
 }
 )";
 
+constexpr float kFov = 60.0f * 3.14159265f / 180.0f;
+constexpr float kMaxDepth = 20.0f;
+
 unsigned int compileShader(unsigned int type, const char* source) {
     unsigned int id = glCreateShader(type);
     if (!id) {
@@ -148,35 +230,119 @@ RendererGL::~RendererGL() {
     if (minimapVbo_) glDeleteBuffers(1, &minimapVbo_);
     if (minimapVao_) glDeleteVertexArrays(1, &minimapVao_);
     if (minimapProgram_) glDeleteProgram(minimapProgram_);
+    if (fieldTex_) glDeleteTextures(1, &fieldTex_);
     if (mapTex_) glDeleteTextures(1, &mapTex_);
+    if (timerQueries_[0]) glDeleteQueries(2, timerQueries_);
+    if (sceneFbo_) glDeleteFramebuffers(1, &sceneFbo_);
+    if (sceneTex_) glDeleteTextures(1, &sceneTex_);
+    if (hitFbo_) glDeleteFramebuffers(1, &hitFbo_);
+    if (hitTex_) glDeleteTextures(1, &hitTex_);
+    if (columnTex_) glDeleteTextures(1, &columnTex_);
     if (vbo_) glDeleteBuffers(1, &vbo_);
     if (vao_) glDeleteVertexArrays(1, &vao_);
+    if (castProgram_) glDeleteProgram(castProgram_);
     if (program_) glDeleteProgram(program_);
 }
 
-bool RendererGL::loadShaders() {
-    unsigned int vs = compileShader(GL_VERTEX_SHADER, kVertSource);
-    unsigned int fs = compileShader(GL_FRAGMENT_SHADER, kFragSource);
-    if (!vs || !fs) return false;
+unsigned int RendererGL::linkProgram(const char* vert, const char* frag) {
+    unsigned int vs = compileShader(GL_VERTEX_SHADER, vert);
+    unsigned int fs = compileShader(GL_FRAGMENT_SHADER, frag);
+    if (!vs || !fs) return 0;
 
-    program_ = glCreateProgram();
-    glAttachShader(program_, vs);
-    glAttachShader(program_, fs);
-    glLinkProgram(program_);
+    unsigned int program = glCreateProgram();
+    glAttachShader(program, vs);
+    glAttachShader(program, fs);
+    glLinkProgram(program);
     glDeleteShader(vs);
     glDeleteShader(fs);
 
     int success;
-    glGetProgramiv(program_, GL_LINK_STATUS, &success);
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
     if (!success) {
         char log[512];
-        glGetProgramInfoLog(program_, sizeof(log), nullptr, log);
+        glGetProgramInfoLog(program, sizeof(log), nullptr, log);
         std::cerr << "Program link failed: " << log << "\n";
+        glDeleteProgram(program);
+        return 0;
+    }
+    return program;
+}
+
+bool RendererGL::loadShaders() {
+    castProgram_ = linkProgram(kVertSource, kCastFrag);
+    program_ = linkProgram(kVertSource, kShadeFrag);
+    return castProgram_ && program_;
+}
+
+bool RendererGL::ensureHitTarget(int columns) {
+    if (columns == hitColumns_) return true;
+    for (unsigned int* tex : {&hitTex_, &columnTex_}) {
+        if (!*tex) glGenTextures(1, tex);
+        glBindTexture(GL_TEXTURE_2D, *tex);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, columns, 1, 0, GL_RGBA, GL_FLOAT, nullptr);
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    if (!hitFbo_) glGenFramebuffers(1, &hitFbo_);
+    glBindFramebuffer(GL_FRAMEBUFFER, hitFbo_);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, hitTex_, 0);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, columnTex_, 0);
+    const GLenum targets[2] = {GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1};
+    glDrawBuffers(2, targets);
+    const bool complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    if (!complete) {
+        std::cerr << "Column hit framebuffer (RGBA32F) is not renderable.\n";
+        return false;
+    }
+    hitColumns_ = columns;
+    return true;
+}
+
+bool RendererGL::ensureSceneTarget(int width, int height) {
+    if (width == sceneWidth_ && height == sceneHeight_) return true;
+    if (!sceneTex_) glGenTextures(1, &sceneTex_);
+    glBindTexture(GL_TEXTURE_2D, sceneTex_);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    if (!sceneFbo_) glGenFramebuffers(1, &sceneFbo_);
+    glBindFramebuffer(GL_FRAMEBUFFER, sceneFbo_);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, sceneTex_, 0);
+    const GLenum target = GL_COLOR_ATTACHMENT0;
+    glDrawBuffers(1, &target);
+    const bool complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    if (!complete) {
+        std::cerr << "Scaled scene framebuffer is not renderable; drawing at full resolution.\n";
         return false;
     }
+    sceneWidth_ = width;
+    sceneHeight_ = height;
     return true;
 }
 
+void RendererGL::readTimers() {
+    if (!timerPending_) return;
+    int available = 0;
+    glGetQueryObjectiv(timerQueries_[1], GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!available) return;  // Never stall the pipeline; try again next frame
+    GLuint64 ns[2] = {0, 0};
+    glGetQueryObjectui64v(timerQueries_[0], GL_QUERY_RESULT, &ns[0]);
+    glGetQueryObjectui64v(timerQueries_[1], GL_QUERY_RESULT, &ns[1]);
+    castGpuMs_ = static_cast<float>(ns[0] * 1e-6);
+    shadeGpuMs_ = static_cast<float>(ns[1] * 1e-6);
+    timerPending_ = false;
+}
+
 bool RendererGL::loadMinimapShaders() {
     unsigned int vs = compileShader(GL_VERTEX_SHADER, kMinimapVert);
     unsigned int fs = compileShader(GL_FRAGMENT_SHADER, kMinimapFrag);
@@ -251,10 +417,9 @@ void main() { fragColor = vec4(uColor, 1.0); }
 }
 
 void RendererGL::uploadMapTexture() {
-    unsigned char pixels[Map::height][Map::width];
-    for (int y = 0; y < Map::height; y++)
-        for (int x = 0; x < Map::width; x++)
-            pixels[y][x] = static_cast<unsigned char>(Map::layout[y][x]);
+    const TileMap& tiles = map_->tiles();
+    std::vector<unsigned char> pixels(static_cast<size_t>(tiles.width()) * tiles.height());
+    tiles.copyRows(pixels.data());
 
     if (!mapTex_) glGenTextures(1, &mapTex_);
     glBindTexture(GL_TEXTURE_2D, mapTex_);
@@ -262,18 +427,50 @@ void RendererGL::uploadMapTexture() {
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, Map::width, Map::height, 0,
-                 GL_RED, GL_UNSIGNED_BYTE, pixels);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);  // Rows are tightly packed bytes
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, tiles.width(), tiles.height(), 0,
+                 GL_RED, GL_UNSIGNED_BYTE, pixels.data());
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void RendererGL::uploadFieldTexture() {
+    const DistanceField& field = map_->distanceField();
+    const DistanceField::Rect& r = field.changed();
+    const bool full = r.x0 == 0 && r.y0 == 0 && r.x1 == field.width() && r.y1 == field.height();
+    const bool created = !fieldTex_;
+    if (created) glGenTextures(1, &fieldTex_);
+    glBindTexture(GL_TEXTURE_2D, fieldTex_);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    if (field.empty()) {
+        const unsigned char none = 0;  // No skipping until a field is built
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, 1, 1, 0, GL_RED, GL_UNSIGNED_BYTE, &none);
+    } else if (created || full) {
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, field.width(), field.height(), 0,
+                     GL_RED, GL_UNSIGNED_BYTE, field.data());
+    } else if (r.y1 > r.y0) {
+        // Key changes only rewrite the area around the doors; re-upload those rows.
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, r.y0, field.width(), r.y1 - r.y0, GL_RED, GL_UNSIGNED_BYTE,
+                        field.data() + static_cast<size_t>(r.y0) * field.width());
+    }
     glBindTexture(GL_TEXTURE_2D, 0);
+    fieldRevision_ = field.revision();
 }
 
-bool RendererGL::init(int width, int height) {
+bool RendererGL::init(int width, int height, const Map& map) {
     winWidth_ = width;
     winHeight_ = height;
+    map_ = &map;
 
     if (!loadShaders()) return false;
     if (!loadMinimapShaders()) return false;
     if (!loadSolidShaders()) return false;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxColumns_);
+    if (!ensureHitTarget(std::min(width, maxColumns_))) return false;
+    glGenQueries(2, timerQueries_);
 
     float quad[] = { -1,-1, 1,-1, -1,1,  -1,1, 1,-1, 1,1 };
     glGenVertexArrays(1, &vao_);
@@ -286,6 +483,7 @@ bool RendererGL::init(int width, int height) {
     glBindVertexArray(0);
 
     uploadMapTexture();
+    uploadFieldTexture();
     return true;
 }
 
@@ -295,7 +493,7 @@ void RendererGL::resize(int width, int height) {
     glViewport(0, 0, width, height);
 }
 
-void RendererGL::draw(const Player& player, bool hasKey, int winWidth, int winHeight) {
+void RendererGL::draw(const Player& player, bool hasKey, int winWidth, int winHeight, float scale) {
     if (winWidth <= 0 || winHeight <= 0) return;
     winWidth_ = winWidth;
     winHeight_ = winHeight;
@@ -304,21 +502,73 @@ void RendererGL::draw(const Player& player, bool hasKey, int winWidth, int winHe
     glClearColor(0.1f, 0.12f, 0.2f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT);
 
-    glUseProgram(program_);
-    glUniform2f(glGetUniformLocation(program_, "uPlayerPos"), static_cast<float>(player.x), static_cast<float>(player.y));
-    glUniform1f(glGetUniformLocation(program_, "uPlayerAngle"), static_cast<float>(player.angle));
-    glUniform1f(glGetUniformLocation(program_, "uFov"), 60.0f * 3.14159265f / 180.0f);
-    glUniform2f(glGetUniformLocation(program_, "uMapSize"), static_cast<float>(Map::width), static_cast<float>(Map::height));
-    glUniform1f(glGetUniformLocation(program_, "uHasKey"), hasKey ? 1.0f : 0.0f);
-    glUniform2f(glGetUniformLocation(program_, "uResolution"), static_cast<float>(winWidth), static_cast<float>(winHeight));
+    // Scaled view size; at full size (or without a scene target) shade straight to the window.
+    int viewWidth = std::max(1, static_cast<int>(winWidth * scale + 0.5f));
+    int viewHeight = std::max(1, static_cast<int>(winHeight * scale + 0.5f));
+    const bool scaled = (viewWidth < winWidth || viewHeight < winHeight) && ensureSceneTarget(viewWidth, viewHeight);
+    if (!scaled) {
+        viewWidth = winWidth;
+        viewHeight = winHeight;
+    }
 
+    if (map_->distanceField().revision() != fieldRevision_) uploadFieldTexture();
+    const int columns = std::min(viewWidth, maxColumns_);
+    if (!ensureHitTarget(columns)) return;
+    readTimers();
+    const bool timed = !timerPending_;
+
+    // Pass 1: one ray per column into the hit texture.
+    if (timed) glBeginQuery(GL_TIME_ELAPSED, timerQueries_[0]);
+    glBindFramebuffer(GL_FRAMEBUFFER, hitFbo_);
+    glViewport(0, 0, columns, 1);
+    const float dirX = static_cast<float>(std::cos(player.angle));
+    const float dirY = static_cast<float>(std::sin(player.angle));
+    const float planeScale = std::tan(kFov / 2.0f);
+    const DistanceField& field = map_->distanceField();
+    glUseProgram(castProgram_);
+    glUniform2f(glGetUniformLocation(castProgram_, "uPlayerPos"), static_cast<float>(player.x), static_cast<float>(player.y));
+    glUniform2f(glGetUniformLocation(castProgram_, "uCamDir"), dirX, dirY);
+    glUniform2f(glGetUniformLocation(castProgram_, "uCamPlane"), -dirY * planeScale, dirX * planeScale);
+    glUniform1f(glGetUniformLocation(castProgram_, "uColumns"), static_cast<float>(columns));
+    glUniform1f(glGetUniformLocation(castProgram_, "uMaxDepth"), kMaxDepth);
+    glUniform1f(glGetUniformLocation(castProgram_, "uFocal"), 0.5f * viewWidth / planeScale);
+    glUniform1f(glGetUniformLocation(castProgram_, "uHasKey"), hasKey ? 1.0f : 0.0f);
+    glUniform1f(glGetUniformLocation(castProgram_, "uUseField"),
+                !field.empty() && field.hasKey() == hasKey ? 1.0f : 0.0f);
     glActiveTexture(GL_TEXTURE0);
     glBindTexture(GL_TEXTURE_2D, mapTex_);
-    glUniform1i(glGetUniformLocation(program_, "uMapTex"), 0);
-
+    glUniform1i(glGetUniformLocation(castProgram_, "uMapTex"), 0);
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, fieldTex_);
+    glUniform1i(glGetUniformLocation(castProgram_, "uFieldTex"), 1);
+    glActiveTexture(GL_TEXTURE0);
     glBindVertexArray(vao_);
     glDrawArrays(GL_TRIANGLES, 0, 6);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    if (timed) glEndQuery(GL_TIME_ELAPSED);
+
+    // Pass 2: every pixel is wall, ceiling or floor by its column's wall height. A scaled
+    // view is shaded offscreen, then stretched over the window (timed with the shading).
+    if (timed) glBeginQuery(GL_TIME_ELAPSED, timerQueries_[1]);
+    if (scaled) glBindFramebuffer(GL_FRAMEBUFFER, sceneFbo_);
+    glViewport(0, 0, viewWidth, viewHeight);
+    glUseProgram(program_);
+    glUniform2f(glGetUniformLocation(program_, "uResolution"), static_cast<float>(viewWidth), static_cast<float>(viewHeight));
+    glBindTexture(GL_TEXTURE_2D, columnTex_);
+    glUniform1i(glGetUniformLocation(program_, "uColumnTex"), 0);
+    glDrawArrays(GL_TRIANGLES, 0, 6);
     glBindVertexArray(0);
+    if (scaled) {
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, sceneFbo_);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+        glBlitFramebuffer(0, 0, viewWidth, viewHeight, 0, 0, winWidth, winHeight, GL_COLOR_BUFFER_BIT, GL_LINEAR);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glViewport(0, 0, winWidth, winHeight);
+    }
+    if (timed) {
+        glEndQuery(GL_TIME_ELAPSED);
+        timerPending_ = true;
+    }
 
     drawMinimap(player, hasKey, winWidth, winHeight);
 }
@@ -353,7 +603,7 @@ void RendererGL::drawMinimap(const Player& player, bool hasKey, int winWidth, in
     (void)winHeight;
     glUseProgram(minimapProgram_);
     glUniform2f(glGetUniformLocation(minimapProgram_, "uPlayerPos"), static_cast<float>(player.x), static_cast<float>(player.y));
-    glUniform2f(glGetUniformLocation(minimapProgram_, "uMapSize"), static_cast<float>(Map::width), static_cast<float>(Map::height));
+    glUniform2f(glGetUniformLocation(minimapProgram_, "uMapSize"), static_cast<float>(map_->width()), static_cast<float>(map_->height()));
     glActiveTexture(GL_TEXTURE0);
     glBindTexture(GL_TEXTURE_2D, mapTex_);
     glUniform1i(glGetUniformLocation(minimapProgram_, "uMapTex"), 0);
@@ -0,0 +1,203 @@
+#include "replay.h"
+#include "map.h"
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+static const char kReplayMagic[8] = {'R', 'C', 'R', 'E', 'P', 'L', 'A', 'Y'};
+
+// FNV-1a over 64-bit words: the storage is a multiple of 64 bytes, and a 16k level hashes
+// in a few tens of milliseconds.
+uint64_t levelFingerprint(const Map& map) {
+    uint64_t hash = 0xcbf29ce484222325ull;
+    auto mix = [&hash](uint64_t word) { hash = (hash ^ word) * 0x100000001b3ull; };
+    const LevelInfo& info = map.info();
+    float spawn[3] = {info.spawnX, info.spawnY, info.spawnAngle};
+    uint32_t spawnBits[3];
+    std::memcpy(spawnBits, spawn, sizeof spawnBits);
+    mix(static_cast<uint64_t>(map.width()) << 32 | static_cast<uint32_t>(map.height()));
+    mix(spawnBits[0]);
+    mix(static_cast<uint64_t>(spawnBits[1]) << 32 | spawnBits[2]);
+    const uint8_t* bytes = map.tiles().storage();
+    const size_t words = map.tiles().bytes() / sizeof(uint64_t);
+    for (size_t i = 0; i < words; ++i) {
+        uint64_t word;
+        std::memcpy(&word, bytes + i * sizeof word, sizeof word);
+        mix(word);
+    }
+    return hash;
+}
+
+static void writeVarint(std::vector<uint8_t>& out, uint32_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+ReplayWriter::ReplayWriter(const Map& map, uint32_t ticksPerSecond, double mouseSensitivity) {
+    std::memset(&header_, 0, sizeof(header_));
+    std::memcpy(header_.magic, kReplayMagic, sizeof(kReplayMagic));
+    header_.version = ReplayHeader::kVersion;
+    header_.headerBytes = sizeof(header_);
+    header_.ticksPerSecond = ticksPerSecond;
+    header_.levelHash = levelFingerprint(map);
+    header_.levelWidth = map.width();
+    header_.levelHeight = map.height();
+    header_.mouseSensitivity = mouseSensitivity;
+}
+
+void ReplayWriter::record(const TickInput& input) {
+    ++ticks_;
+    if (input.buttons == buttons_ && input.mouseDx == 0) {
+        ++skipped_;
+        return;
+    }
+    writeVarint(bytes_, skipped_);
+    bytes_.push_back(static_cast<uint8_t>((input.buttons & Button::All) | (input.mouseDx ? 0x80 : 0)));
+    if (input.mouseDx) {
+        const int32_t dx = input.mouseDx;
+        writeVarint(bytes_, (static_cast<uint32_t>(dx) << 1) ^ static_cast<uint32_t>(dx >> 31));  // Zigzag
+    }
+    buttons_ = input.buttons & Button::All;
+    skipped_ = 0;
+}
+
+bool ReplayWriter::save(const std::string& path, const GameSession& finalState) const {
+    ReplayHeader h = header_;
+    h.tickCount = ticks_;
+    h.finalX = finalState.player().x;
+    h.finalY = finalState.player().y;
+    h.finalAngle = finalState.player().angle;
+    h.score = finalState.score();
+    h.hasKey = finalState.hasKey();
+    h.hasWon = finalState.hasWon();
+    h.hasLost = finalState.hasLost();
+    h.inputBytes = bytes_.size();
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+    out.write(reinterpret_cast<const char*>(bytes_.data()), static_cast<std::streamsize>(bytes_.size()));
+    if (!out) {
+        std::cerr << "Cannot write " << path << "\n";
+        return false;
+    }
+    return true;
+}
+
+bool Replay::load(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        std::cerr << "Cannot open " << path << "\n";
+        return false;
+    }
+    ReplayHeader h;
+    if (!in.read(reinterpret_cast<char*>(&h), sizeof(h))) {
+        std::cerr << path << ": not a replay (too small)\n";
+        return false;
+    }
+    if (std::memcmp(h.magic, kReplayMagic, sizeof(kReplayMagic)) != 0) {
+        std::cerr << path << ": not a replay (bad magic)\n";
+        return false;
+    }
+    if (h.version != ReplayHeader::kVersion || h.headerBytes != sizeof(h)) {
+        std::cerr << path << ": unsupported replay version " << h.version << "\n";
+        return false;
+    }
+    std::vector<uint8_t> inputs((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    if (h.inputBytes != inputs.size()) {
+        std::cerr << path << ": corrupt replay header\n";
+        return false;
+    }
+    if (h.ticksPerSecond != GameSession::kTicksPerSecond) {
+        std::cerr << path << ": recorded at " << h.ticksPerSecond << " Hz, the game ticks at "
+                  << GameSession::kTicksPerSecond << " Hz\n";
+        return false;
+    }
+    header_ = h;
+    inputs_ = std::move(inputs);
+    return true;
+}
+
+Replay::Cursor::Cursor(const Replay& replay)
+    : pos_(replay.inputs_.data()), end_(replay.inputs_.data() + replay.inputs_.size()),
+      count_(replay.header_.tickCount) {
+    haveRecord_ = pos_ != end_ && readVarint(untilRecord_);
+}
+
+bool Replay::Cursor::readVarint(uint32_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+        if (pos_ == end_) break;
+        const uint8_t byte = *pos_++;
+        value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    corrupt_ = true;
+    return false;
+}
+
+bool Replay::Cursor::next(TickInput& input) {
+    if (tick_ >= count_ || corrupt_) return false;
+    ++tick_;
+    input.buttons = buttons_;
+    input.mouseDx = 0;
+    if (!haveRecord_) return true;  // Past the last record: its buttons stay held
+    if (untilRecord_ > 0) {
+        --untilRecord_;
+        return true;
+    }
+
+    if (pos_ == end_) {
+        corrupt_ = true;
+        return false;
+    }
+    const uint8_t byte = *pos_++;
+    buttons_ = byte & Button::All;
+    input.buttons = buttons_;
+    if (byte & 0x80) {
+        uint32_t zigzag;
+        if (!readVarint(zigzag)) return false;
+        input.mouseDx = static_cast<int32_t>(zigzag >> 1) ^ -static_cast<int32_t>(zigzag & 1);
+    }
+    haveRecord_ = pos_ != end_ && readVarint(untilRecord_);
+    return !corrupt_;
+}
+
+bool Replay::matches(const GameSession& session, std::string* why) const {
+    auto fail = [why](const char* what) {
+        if (why) *why = what;
+        return false;
+    };
+    const Player& p = session.player();
+    if (p.x != header_.finalX || p.y != header_.finalY || p.angle != header_.finalAngle)
+        return fail("final position differs");
+    if (session.hasKey() != (header_.hasKey != 0)) return fail("key state differs");
+    if (session.hasWon() != (header_.hasWon != 0) || session.hasLost() != (header_.hasLost != 0))
+        return fail("outcome differs");
+    if (session.score() != header_.score) return fail("score differs");
+    if (why) why->clear();
+    return true;
+}
+
+bool Replay::verify(const Map& map, uint64_t levelHash, std::string* why, uint32_t* ticksPlayed) const {
+    if (ticksPlayed) *ticksPlayed = 0;
+    if (levelHash != header_.levelHash || map.width() != header_.levelWidth || map.height() != header_.levelHeight) {
+        if (why) *why = "recorded on a different level";
+        return false;
+    }
+    GameSession session(map);
+    Cursor cursor(*this);
+    const double seconds = tickSeconds();
+    TickInput input;
+    uint32_t played = 0;
+    for (; cursor.next(input); ++played) session.tick(input.toSession(session, header_.mouseSensitivity), seconds);
+    if (ticksPlayed) *ticksPlayed = played;
+    if (cursor.corrupt() || cursor.tick() != header_.tickCount) {
+        if (why) *why = "input stream is corrupt";
+        return false;
+    }
+    return matches(session, why);
+}
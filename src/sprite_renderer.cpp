@@ -0,0 +1,158 @@
+/*
+ * Billboard sprites. A sprite at relative position r is written as r = depth * dir +
+ * side * plane; depth is its perpendicular distance (the same measure as the wall
+ * z-buffer) and side / depth is its camera-plane coordinate in [-1, 1]. Heights follow
+ * Raycaster::wallHeight, so a size-1 sprite is exactly as tall as a wall at its depth
+ * and stands on the same floor line.
+ */
+#include "sprite_renderer.h"
+#include "framebuffer.h"
+#include "thread_pool.h"
+#include "wall_textures.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+constexpr float kNearPlane = 0.05f;
+
+uint32_t floatKey(float depth) {
+    uint32_t bits;
+    std::memcpy(&bits, &depth, sizeof bits);
+    return ~bits;  // Depths are positive, so their bits order like the values; invert for far first
+}
+
+} // namespace
+
+void SpriteRenderer::sortByDepth() {
+    // LSD radix sort, 8 bits per pass; a pass where every key has the same digit is skipped.
+    const size_t n = visible_.size();
+    sorted_.resize(n);
+    sortedKeys_.resize(n);
+    for (int shift = 0; shift < 32; shift += 8) {
+        uint32_t count[257] = {};
+        for (size_t i = 0; i < n; ++i) ++count[((keys_[i] >> shift) & 0xFF) + 1];
+        if (count[((keys_[0] >> shift) & 0xFF) + 1] == n) continue;
+        for (int d = 0; d < 256; ++d) count[d + 1] += count[d];
+        for (size_t i = 0; i < n; ++i) {
+            const uint32_t slot = count[(keys_[i] >> shift) & 0xFF]++;
+            sorted_[slot] = visible_[i];
+            sortedKeys_[slot] = keys_[i];
+        }
+        visible_.swap(sorted_);
+        keys_.swap(sortedKeys_);
+    }
+}
+
+void SpriteRenderer::drawSprite(Framebuffer& fb, const Projected& p, const Sprite& s, int x0, int x1,
+                                const float* depth, const WallTextures& textures) {
+    constexpr int kLast = WallTextures::kSize - 1;
+    const int height = fb.height();
+    const float wallHalf = height / p.depth;  // Half a wall's height; the floor line is at height / 2 + wallHalf
+    const float spriteBottom = height * 0.5f + wallHalf;
+    const float spriteHeight = s.size * 2.0f * wallHalf;
+    const float spriteTop = spriteBottom - spriteHeight;
+
+    // Texture column of each screen column, or null where a wall is in front or the
+    // column is fully transparent; the rows drawn are the union of the opaque spans.
+    const uint8_t* columns[1 << kBandLog2];
+    const float texelsPerColumn = WallTextures::kSize / p.width;
+    int first = WallTextures::kSize, end = 0;
+    for (int x = x0; x < x1; ++x) {
+        columns[x - x0] = nullptr;
+        if (depth[x] <= p.depth) continue;
+        const int u = std::min(static_cast<int>((x + 0.5f - p.screenX) * texelsPerColumn), kLast);
+        const WallTextures::Span span = textures.spriteSpan(s.texture, u);
+        if (span.first == span.end) continue;
+        columns[x - x0] = textures.spriteColumn(s.texture, u);
+        first = std::min<int>(first, span.first);
+        end = std::max<int>(end, span.end);
+    }
+    if (first >= end) return;
+
+    // Row by row, so stores run along the framebuffer rather than down it.
+    const float rowsPerTexel = spriteHeight / WallTextures::kSize;
+    const float texelsPerRow = WallTextures::kSize / spriteHeight;
+    const int top = std::max(static_cast<int>(std::ceil(spriteTop + first * rowsPerTexel - 0.5f)), 0);
+    const int bottom = std::min(static_cast<int>(std::ceil(spriteTop + end * rowsPerTexel - 0.5f)), height) - 1;
+    const uint32_t* colormap = textures.colormap(p.depth, 0);
+    const uint32_t vStep = static_cast<uint32_t>(texelsPerRow * 65536.0f);
+    uint32_t v = static_cast<uint32_t>((top + 0.5f - spriteTop) * texelsPerRow * 65536.0f);
+    for (int y = top; y <= bottom; ++y, v += vStep) {
+        const int row = std::min(static_cast<int>(v >> 16), kLast);
+        uint32_t* out = fb.row(y);
+        for (int x = x0; x < x1; ++x) {
+            const uint8_t* column = columns[x - x0];
+            if (!column) continue;
+            const uint8_t texel = column[row];
+            if (texel != WallTextures::kTransparent) out[x] = colormap[texel];
+        }
+    }
+}
+
+SpriteRenderer::Stats SpriteRenderer::draw(Framebuffer& fb, const Raycaster::Camera& cam, float maxDepth,
+                                           const float* depth, const Sprite* sprites, size_t count,
+                                           const WallTextures& textures, ThreadPool* pool) {
+    Stats stats;
+    const int width = fb.width();
+    const int tiles = (width + (1 << kTileLog2) - 1) >> kTileLog2;
+    tileDepth_.assign(tiles, 0.0f);
+    for (int x = 0; x < width; ++x)
+        tileDepth_[x >> kTileLog2] = std::max(tileDepth_[x >> kTileLog2], depth[x]);
+
+    const float invDet = 1.0f / (cam.dirX * cam.planeY - cam.planeX * cam.dirY);
+    const float pixelsPerUnit = width * 0.5f / std::sqrt(cam.planeX * cam.planeX + cam.planeY * cam.planeY);
+    visible_.clear();
+    keys_.clear();
+    for (size_t i = 0; i < count; ++i) {
+        const Sprite& s = sprites[i];
+        const float rx = s.x - cam.originX, ry = s.y - cam.originY;
+        Projected p;
+        p.depth = invDet * (cam.planeY * rx - cam.planeX * ry);
+        if (p.depth < kNearPlane || p.depth >= maxDepth) continue;
+        const float side = invDet * (cam.dirX * ry - cam.dirY * rx);
+        p.width = s.size * pixelsPerUnit / p.depth;
+        p.screenX = (side / p.depth + 1.0f) * width * 0.5f - p.width * 0.5f;
+        p.x0 = std::max(static_cast<int>(std::ceil(p.screenX - 0.5f)), 0);
+        p.x1 = std::min(static_cast<int>(std::ceil(p.screenX + p.width - 0.5f)), width);
+        if (p.x0 >= p.x1) continue;
+        ++stats.visible;
+
+        bool hidden = true;
+        for (int t = p.x0 >> kTileLog2; t <= (p.x1 - 1) >> kTileLog2 && hidden; ++t) hidden = tileDepth_[t] <= p.depth;
+        if (hidden) {
+            ++stats.occluded;
+            continue;
+        }
+        // The tile test is conservative; a sprite that loses to the wall in every one of
+        // its columns is dropped here too, so the drawing pass only sees drawn sprites.
+        while (p.x0 < p.x1 && depth[p.x0] <= p.depth) ++p.x0;
+        while (p.x1 > p.x0 && depth[p.x1 - 1] <= p.depth) --p.x1;
+        if (p.x0 >= p.x1) {
+            ++stats.occluded;
+            continue;
+        }
+        p.sprite = static_cast<uint32_t>(i);
+        visible_.push_back(p);
+        keys_.push_back(floatKey(p.depth));
+    }
+    stats.drawn = static_cast<int>(visible_.size());
+    if (visible_.empty()) return stats;
+    sortByDepth();
+
+    // Columns are independent (each is painted far to near), so bands of them are the
+    // unit of parallel work, as in the wall pass.
+    auto drawColumns = [&](int begin, int end) {
+        for (int band = begin; band < end; ++band) {
+            const int bandX0 = band << kBandLog2, bandX1 = std::min((band + 1) << kBandLog2, width);
+            for (const Projected& p : visible_)
+                if (p.x0 < bandX1 && p.x1 > bandX0)
+                    drawSprite(fb, p, sprites[p.sprite], std::max(p.x0, bandX0), std::min(p.x1, bandX1), depth, textures);
+        }
+    };
+    const int bands = (width + (1 << kBandLog2) - 1) >> kBandLog2;
+    if (pool) pool->parallelFor(bands, 1, drawColumns);
+    else drawColumns(0, bands);
+    return stats;
+}
@@ -0,0 +1,305 @@
+/*
+ * Text cache. A font key names what a glyph is rasterized with: a TrueType point size, or
+ * (with kBlockFlag) a block-font cell size and character gap. Glyph keys add the
+ * codepoint; string keys add the color and the text.
+ */
+#include "text_renderer.h"
+#include "framebuffer.h"
+#include <algorithm>
+#include <iterator>
+
+namespace {
+
+constexpr uint32_t kBlockFlag = 0x80000000u;
+
+uint32_t blockFont(int blockW, int blockH, int gap) {
+    return kBlockFlag | static_cast<uint32_t>(std::clamp(blockW, 1, 255)) << 16 |
+           static_cast<uint32_t>(std::clamp(blockH, 1, 255)) << 8 | static_cast<uint32_t>(std::clamp(gap, 0, 255));
+}
+int blockW(uint32_t font) { return (font >> 16) & 0xFF; }
+int blockH(uint32_t font) { return (font >> 8) & 0xFF; }
+int blockGap(uint32_t font) { return font & 0xFF; }
+
+// Simple 5x7 block font: 1 = on. Each char is 5 cols, 7 rows. Space = empty.
+const unsigned char kBlockFont[][35] = {
+    {1,1,1,1,1, 1,0,0,0,0, 1,1,1,0,0, 1,0,0,0,0, 1,0,0,0,0, 1,0,0,0,0, 1,0,0,0,0}, // F
+    {0,0,1,0,0, 0,0,1,0,0, 0,0,1,0,0, 0,0,1,0,0, 0,0,1,0,0, 0,0,1,0,0, 0,0,1,0,0}, // I
+    {1,0,0,0,1, 1,1,0,0,1, 1,0,1,0,1, 1,0,0,1,1, 1,0,0,0,1, 1,0,0,0,1, 1,0,0,0,1}, // N
+    {1,1,1,0,0, 1,0,0,1,0, 1,0,0,1,0, 1,0,0,1,0, 1,0,0,1,0, 1,0,0,1,0, 1,1,1,0,0}, // D
+    {0,0,0,0,0, 0,0,0,0,0, 0,0,0,0,0, 0,0,0,0,0, 0,0,0,0,0, 0,0,0,0,0, 0,0,0,0,0}, // space
+    {1,1,1,1,1, 0,0,1,0,0, 0,0,1,0,0, 0,0,1,0,0, 0,0,1,0,0, 0,0,1,0,0, 0,0,1,0,0}, // T
+    {1,0,0,0,1, 1,0,0,0,1, 1,0,0,0,1, 1,1,1,1,1, 1,0,0,0,1, 1,0,0,0,1, 1,0,0,0,1}, // H
+    {1,1,1,1,1, 1,0,0,0,1, 1,0,0,0,1, 1,1,1,1,1, 1,0,0,0,1, 1,0,0,0,1, 1,1,1,1,1}, // E
+    {0,0,0,0,0, 0,0,0,0,0, 0,0,0,0,0, 0,0,0,0,0, 0,0,0,0,0, 0,0,0,0,0, 0,0,0,0,0}, // space
+    {0,1,1,1,0, 1,0,0,0,1, 1,0,0,0,1, 1,0,0,0,1, 1,0,0,0,1, 1,0,0,0,1, 0,1,1,1,0}, // O
+    {1,1,1,0,0, 1,0,0,1,0, 1,0,0,1,0, 1,1,1,0,0, 1,0,1,0,0, 1,0,0,1,0, 1,0,0,0,1}, // R
+    {1,0,0,0,1, 1,1,0,1,1, 1,0,1,0,1, 1,0,0,0,1, 1,0,0,0,1, 1,0,0,0,1, 1,0,0,0,1}, // W
+    {0,0,1,0,0, 0,0,1,0,0, 0,0,1,0,0, 0,0,1,0,0, 0,0,1,0,0, 0,0,1,0,0, 0,0,1,0,0}, // I
+    {1,0,0,0,1, 1,1,0,0,1, 1,0,1,0,1, 1,0,0,1,1, 1,0,0,0,1, 1,0,0,0,1, 1,0,0,0,1}, // N
+    {1,1,1,1,1, 0,0,1,0,0, 0,0,1,0,0, 0,0,1,0,0, 0,0,1,0,0, 0,0,1,0,0, 0,0,1,0,0}, // !
+    {0,0,1,0,0, 0,1,0,1,0, 1,0,0,0,1, 1,1,1,1,1, 1,0,0,0,1, 1,0,0,0,1, 1,0,0,0,1}, // A
+    {1,1,1,0,0, 1,0,0,1,0, 1,0,0,1,0, 1,1,1,0,0, 1,0,0,1,0, 1,0,0,1,0, 1,1,1,0,0}, // B
+    // Digits 0-9 for timer and score
+    {0,1,1,1,0, 1,0,0,0,1, 1,0,0,0,1, 1,0,0,0,1, 1,0,0,0,1, 1,0,0,0,1, 0,1,1,1,0}, // 0
+    {0,0,1,0,0, 0,1,1,0,0, 0,0,1,0,0, 0,0,1,0,0, 0,0,1,0,0, 0,0,1,0,0, 0,1,1,1,0}, // 1
+    {0,1,1,1,0, 1,0,0,0,1, 0,0,0,0,1, 0,0,1,1,0, 0,1,0,0,0, 1,0,0,0,0, 1,1,1,1,1}, // 2
+    {1,1,1,1,0, 0,0,0,0,1, 0,0,0,1,0, 0,0,1,1,0, 0,0,0,0,1, 1,0,0,0,1, 0,1,1,1,0}, // 3
+    {0,0,0,1,0, 0,0,1,1,0, 0,1,0,1,0, 1,0,0,1,0, 1,1,1,1,1, 0,0,0,1,0, 0,0,0,1,0}, // 4
+    {1,1,1,1,1, 1,0,0,0,0, 1,1,1,1,0, 0,0,0,0,1, 0,0,0,0,1, 1,0,0,0,1, 0,1,1,1,0}, // 5
+    {0,1,1,1,0, 1,0,0,0,0, 1,1,1,1,0, 1,0,0,0,1, 1,0,0,0,1, 1,0,0,0,1, 0,1,1,1,0}, // 6
+    {1,1,1,1,1, 0,0,0,0,1, 0,0,0,1,0, 0,0,1,0,0, 0,1,0,0,0, 0,1,0,0,0, 0,1,0,0,0}, // 7
+    {0,1,1,1,0, 1,0,0,0,1, 1,0,0,0,1, 0,1,1,1,0, 1,0,0,0,1, 1,0,0,0,1, 0,1,1,1,0}, // 8
+    {0,1,1,1,0, 1,0,0,0,1, 1,0,0,0,1, 0,1,1,1,1, 0,0,0,0,1, 0,0,0,0,1, 0,1,1,1,0}, // 9
+    {0,0,0,0,0, 0,0,0,0,0, 0,0,1,0,0, 0,0,0,0,0, 0,0,1,0,0, 0,0,0,0,0, 0,0,0,0,0}, // :
+    {1,0,0,0,0, 1,0,0,0,0, 1,0,0,0,0, 1,0,0,0,0, 1,0,0,0,0, 1,0,0,0,0, 1,1,1,1,1}, // L
+    {0,1,1,1,0, 1,0,0,0,0, 0,1,1,0,0, 0,0,0,1,0, 0,0,0,0,1, 1,0,0,0,1, 0,1,1,1,0}, // S
+    {0,0,0,0,0, 0,0,0,0,0, 0,0,0,0,0, 1,1,1,1,1, 0,0,0,0,0, 0,0,0,0,0, 0,0,0,0,0}, // -
+    {1,0,0,0,1, 1,1,0,1,1, 1,0,1,0,1, 1,0,0,0,1, 1,0,0,0,1, 1,0,0,0,1, 1,0,0,0,1}, // M
+    {0,1,1,1,0, 1,0,0,0,1, 1,0,0,0,0, 1,0,0,0,0, 1,0,0,0,0, 1,0,0,0,1, 0,1,1,1,0}, // C
+};
+int blockCharIndex(uint32_t c) {
+    if (c >= '0' && c <= '9') return 17 + static_cast<int>(c - '0');
+    switch (c) {
+        case 'F': return 0; case 'I': return 1; case 'N': return 2; case 'D': return 3;
+        case ' ': return 4; case 'T': return 5; case 'H': return 6; case 'E': return 7;
+        case 'O': return 9; case 'R': return 10; case 'W': return 11; case '!': return 14;
+        case 'A': return 15; case 'B': return 16; case ':': return 27; case 'L': return 28;
+        case 'S': return 29; case '-': return 30; case 'M': return 31; case 'C': return 32;
+        default: return 4;
+    }
+}
+
+// Decodes one UTF-8 sequence and advances p; a malformed byte is taken as itself.
+uint32_t nextCodepoint(const char*& p) {
+    const unsigned char lead = static_cast<unsigned char>(*p++);
+    const int extra = lead >= 0xF0 ? 3 : (lead >= 0xE0 ? 2 : (lead >= 0xC0 ? 1 : 0));
+    uint32_t c = extra ? lead & (0x3F >> extra) : lead;
+    for (int i = 0; i < extra; ++i) {
+        if ((static_cast<unsigned char>(*p) & 0xC0) != 0x80) return lead;
+        c = (c << 6) | (static_cast<unsigned char>(*p++) & 0x3F);
+    }
+    return c;
+}
+
+} // namespace
+
+void TextRenderer::setFont(TTF_Font* font) {
+    if (font == font_) return;
+    font_ = font;
+    fontSize_ = 0;
+    glyphs_.clear();
+    lineHeights_.clear();
+    strings_.clear();
+    shelfX_ = shelfY_ = shelfH_ = 0;
+    ++atlasGeneration_;
+}
+
+void TextRenderer::draw(Framebuffer& fb, const char* text, int x, int y, int fontSize, uint32_t color, bool centerX) {
+    if (!font_ || !text || !*text) return;
+    const Image& image = string(static_cast<uint32_t>(std::clamp(fontSize, 1, 0x7FFF)), text, color);
+    blit(fb, image, centerX ? x - image.w / 2 : x, y - image.h / 2);
+}
+
+void TextRenderer::drawBlock(Framebuffer& fb, const char* text, int x, int y, int blockW, int blockH, int gap,
+                             uint32_t color, bool centered) {
+    if (!text || !*text) return;
+    const Image& image = string(blockFont(blockW, blockH, gap), text, color);
+    if (centered) {
+        x -= image.w / 2;
+        y -= image.h / 2;
+    }
+    blit(fb, image, x, y);
+}
+
+void TextRenderer::blit(Framebuffer& fb, const Image& image, int x, int y) {
+    for (const Run& r : image.runs) {
+        if (r.solid) fb.fillRect(x + r.x0, y + r.y, r.x1 - r.x0, r.h, image.color);
+        else fb.blendImage(&image.pixels[static_cast<size_t>(r.y) * image.w + r.x0], image.w, r.x1 - r.x0, r.h, x + r.x0, y + r.y);
+    }
+}
+
+TextRenderer::Stats TextRenderer::endFrame() {
+    for (auto it = strings_.begin(); it != strings_.end();)
+        it = frame_ - it->second.lastFrame > kMaxIdleFrames ? strings_.erase(it) : std::next(it);
+    const Stats stats = stats_;
+    stats_ = Stats();
+    ++frame_;
+    return stats;
+}
+
+const TextRenderer::Image& TextRenderer::string(uint32_t font, const char* text, uint32_t color) {
+    key_.assign(reinterpret_cast<const char*>(&font), sizeof font);
+    key_.append(reinterpret_cast<const char*>(&color), sizeof color);
+    key_ += text;
+    auto it = strings_.find(key_);
+    if (it == strings_.end()) {
+        it = strings_.emplace(key_, Image()).first;
+        compose(font, text, color, it->second);
+        ++stats_.composed;
+    }
+    it->second.lastFrame = frame_;
+    ++stats_.strings;
+    return it->second;
+}
+
+void TextRenderer::compose(uint32_t font, const char* text, uint32_t color, Image& image) {
+    const bool block = (font & kBlockFlag) != 0;
+    const int gap = block ? blockGap(font) : 0;
+    int width = 0;
+    // If the atlas fills up and is cleared part way, the boxes laid out before that are
+    // stale; the second pass starts on the fresh atlas, which holds any one string.
+    for (int pass = 0; pass < 2; ++pass) {
+        const uint32_t generation = atlasGeneration_;
+        layout_.clear();
+        int pen = 0;
+        uint32_t previous = 0;
+        width = 0;
+        for (const char* p = text; *p;) {
+            const uint32_t c = nextCodepoint(p);
+            if (previous) pen += gap;
+#ifdef HAS_SDL2_TTF
+            if (!block && previous) {
+                lineHeight(font);  // Selects the size
+                pen += TTF_GetFontKerningSizeGlyphs32(font_, previous, c);
+            }
+#endif
+            const Glyph& g = glyph(font, c);
+            layout_.emplace_back(g, pen);
+            width = std::max({width, pen + g.w, pen + g.advance});
+            pen += g.advance;
+            previous = c;
+        }
+        if (generation == atlasGeneration_) break;
+    }
+
+    image.w = width;
+    image.h = lineHeight(font);
+    image.pixels.assign(static_cast<size_t>(image.w) * image.h, color & 0x00FFFFFFu);
+    const uint32_t alpha = color >> 24;
+    for (const auto& [g, pen] : layout_) {
+        const int x0 = std::max(pen, 0), x1 = std::min(pen + g.w, image.w);
+        const int rows = std::min<int>(g.h, image.h);
+        for (int y = 0; y < rows; ++y) {
+            const uint8_t* coverage = &atlas_[static_cast<size_t>(g.atlasY + y) * kAtlasSize + g.atlasX + (x0 - pen)];
+            uint32_t* out = &image.pixels[static_cast<size_t>(y) * image.w];
+            for (int x = x0; x < x1; ++x, ++coverage) {
+                const uint32_t a = (*coverage * alpha + 127) / 255;
+                if (a > (out[x] >> 24)) out[x] = (out[x] & 0x00FFFFFFu) | (a << 24);  // Overlapping glyphs keep the max
+            }
+        }
+    }
+
+    image.color = color | 0xFF000000u;
+    image.runs.clear();
+    open_.clear();
+    for (int y = 0; y < image.h; ++y) {
+        const uint32_t* row = &image.pixels[static_cast<size_t>(y) * image.w];
+        next_.clear();
+        size_t o = 0;  // Both the open runs and this row's runs are in x order
+        for (int x = 0; x < image.w;) {
+            const uint32_t a = row[x] >> 24;
+            const int begin = x;
+            if (a == 0) {
+                while (x < image.w && (row[x] >> 24) == 0) ++x;
+                continue;
+            }
+            const bool solid = a == 255;
+            while (x < image.w && (row[x] >> 24) != 0 && ((row[x] >> 24) == 255) == solid) ++x;
+            Run run{static_cast<int16_t>(begin), static_cast<int16_t>(x), static_cast<int16_t>(y), 1, solid};
+            if (!solid) {
+                image.runs.push_back(run);
+                continue;
+            }
+            for (; o < open_.size() && open_[o].x0 < begin; ++o) image.runs.push_back(open_[o]);
+            if (o < open_.size() && open_[o].x0 == begin && open_[o].x1 == x) {
+                run = open_[o++];
+                ++run.h;
+            }
+            next_.push_back(run);
+        }
+        for (; o < open_.size(); ++o) image.runs.push_back(open_[o]);
+        open_.swap(next_);
+    }
+    image.runs.insert(image.runs.end(), open_.begin(), open_.end());
+}
+
+const TextRenderer::Glyph& TextRenderer::glyph(uint32_t font, uint32_t codepoint) {
+    const uint64_t key = static_cast<uint64_t>(font) << 32 | codepoint;
+    auto it = glyphs_.find(key);
+    if (it != glyphs_.end()) return it->second;
+    Glyph g;
+    if (!rasterize(font, codepoint, g)) {
+        // Atlas full: start it over. Composed strings keep their own pixels.
+        glyphs_.clear();
+        shelfX_ = shelfY_ = shelfH_ = 0;
+        ++atlasGeneration_;
+        g = Glyph();
+        rasterize(font, codepoint, g);
+    }
+    ++stats_.glyphs;
+    return glyphs_.emplace(key, g).first->second;
+}
+
+bool TextRenderer::rasterize(uint32_t font, uint32_t codepoint, Glyph& g) {
+    if (font & kBlockFlag) {
+        const int bw = blockW(font), bh = blockH(font);
+        const unsigned char* cells = kBlockFont[blockCharIndex(codepoint)];
+        g.advance = static_cast<int16_t>(5 * bw);
+        if (std::find(cells, cells + 35, 1) == cells + 35) return true;  // Blank: advance only
+        if (!allocate(5 * bw, 7 * bh, g)) return false;
+        for (int y = 0; y < g.h; ++y)
+            for (int x = 0; x < g.w; ++x)
+                atlas_[static_cast<size_t>(g.atlasY + y) * kAtlasSize + g.atlasX + x] = cells[(y / bh) * 5 + x / bw] ? 255 : 0;
+        return true;
+    }
+#ifdef HAS_SDL2_TTF
+    lineHeight(font);  // Selects the size
+    int minX, maxX, minY, maxY, advance;
+    if (TTF_GlyphMetrics32(font_, codepoint, &minX, &maxX, &minY, &maxY, &advance) == 0)
+        g.advance = static_cast<int16_t>(advance);
+    SDL_Surface* surf = TTF_RenderGlyph32_Blended(font_, codepoint, SDL_Color{255, 255, 255, 255});  // 32-bit ARGB
+    if (!surf) return true;
+    const bool placed = allocate(surf->w, surf->h, g);
+    for (int y = 0; placed && y < g.h; ++y) {
+        const uint32_t* src = reinterpret_cast<const uint32_t*>(static_cast<const uint8_t*>(surf->pixels) + y * surf->pitch);
+        for (int x = 0; x < g.w; ++x)
+            atlas_[static_cast<size_t>(g.atlasY + y) * kAtlasSize + g.atlasX + x] = static_cast<uint8_t>(src[x] >> 24);
+    }
+    SDL_FreeSurface(surf);
+    return placed;
+#else
+    (void)codepoint;
+    return true;
+#endif
+}
+
+bool TextRenderer::allocate(int w, int h, Glyph& g) {
+    if (w <= 0 || h <= 0 || w > kAtlasSize || h > kAtlasSize) return true;  // Nothing to store, or never fits
+    if (shelfX_ + w > kAtlasSize) {
+        shelfY_ += shelfH_;
+        shelfX_ = shelfH_ = 0;
+    }
+    if (shelfY_ + h > kAtlasSize) return false;
+    g.atlasX = static_cast<int16_t>(shelfX_);
+    g.atlasY = static_cast<int16_t>(shelfY_);
+    g.w = static_cast<int16_t>(w);
+    g.h = static_cast<int16_t>(h);
+    shelfX_ += w;
+    shelfH_ = std::max(shelfH_, h);
+    return true;
+}
+
+int TextRenderer::lineHeight(uint32_t font) {
+    if (font & kBlockFlag) return 7 * blockH(font);
+#ifdef HAS_SDL2_TTF
+    if (fontSize_ != static_cast<int>(font)) {
+        TTF_SetFontSize(font_, static_cast<int>(font));
+        fontSize_ = static_cast<int>(font);
+    }
+    auto it = lineHeights_.find(font);
+    if (it == lineHeights_.end()) it = lineHeights_.emplace(font, TTF_FontHeight(font_)).first;
+    return it->second;
+#else
+    return 0;
+#endif
+}
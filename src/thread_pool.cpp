@@ -0,0 +1,124 @@
+/*
+ * Persistent work-stealing pool. Workers sleep on a condition variable between jobs;
+ * within a job, tile claiming is lock-free (one CAS per tile).
+ */
+#include "thread_pool.h"
+#include <algorithm>
+
+namespace {
+
+uint64_t packRange(uint32_t begin, uint32_t end) { return (static_cast<uint64_t>(begin) << 32) | end; }
+uint32_t rangeBegin(uint64_t r) { return static_cast<uint32_t>(r >> 32); }
+uint32_t rangeEnd(uint64_t r) { return static_cast<uint32_t>(r); }
+
+} // namespace
+
+ThreadPool::ThreadPool(int workers)
+    : runs_(new Run[std::max(workers, 0) + 1]) {
+    for (int i = 0; i < workers; ++i)
+        threads_.emplace_back(&ThreadPool::workerLoop, this, i + 1);
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    for (std::thread& t : threads_) t.join();
+}
+
+void ThreadPool::run(int count, int grain, TaskFn fn, void* ctx) {
+    if (count <= 0) return;
+    grain = std::max(grain, 1);
+    const int tiles = (count + grain - 1) / grain;
+    if (threads_.empty() || tiles == 1) {
+        for (int b = 0; b < count; b += grain) fn(ctx, b, std::min(count, b + grain));
+        return;
+    }
+
+    // Deal contiguous runs of tiles: neighbouring columns stay on one core unless stolen.
+    const int slots = concurrency();
+    for (int s = 0; s < slots; ++s) {
+        uint32_t b = static_cast<uint32_t>(static_cast<int64_t>(tiles) * s / slots);
+        uint32_t e = static_cast<uint32_t>(static_cast<int64_t>(tiles) * (s + 1) / slots);
+        runs_[s].range.store(packRange(b, e), std::memory_order_relaxed);
+    }
+    fn_ = fn;
+    ctx_ = ctx;
+    count_ = count;
+    grain_ = grain;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++generation_;
+        activeWorkers_ = workerCount();
+    }
+    wake_.notify_all();
+
+    runSlot(0);
+
+    // Every worker must leave runSlot() before ctx goes out of scope.
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_.wait(lock, [this] { return activeWorkers_ == 0; });
+    fn_ = nullptr;
+    ctx_ = nullptr;
+}
+
+void ThreadPool::workerLoop(int slot) {
+    uint64_t seen = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_.wait(lock, [&] { return stopping_ || generation_ != seen; });
+            if (stopping_) return;
+            seen = generation_;
+        }
+        runSlot(slot);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (--activeWorkers_ == 0) done_.notify_one();
+        }
+    }
+}
+
+void ThreadPool::runSlot(int slot) {
+    int tile;
+    while (popFront(slot, tile)) runTile(tile);
+
+    const int slots = concurrency();
+    for (int i = 1; i < slots; ++i) {
+        int victim = (slot + i) % slots;
+        while (stealBack(victim, tile)) runTile(tile);
+    }
+}
+
+void ThreadPool::runTile(int tile) {
+    int begin = tile * grain_;
+    fn_(ctx_, begin, std::min(count_, begin + grain_));
+}
+
+bool ThreadPool::popFront(int slot, int& tile) {
+    std::atomic<uint64_t>& range = runs_[slot].range;
+    uint64_t r = range.load(std::memory_order_acquire);
+    for (;;) {
+        uint32_t b = rangeBegin(r), e = rangeEnd(r);
+        if (b >= e) return false;
+        if (range.compare_exchange_weak(r, packRange(b + 1, e), std::memory_order_acq_rel)) {
+            tile = static_cast<int>(b);
+            return true;
+        }
+    }
+}
+
+bool ThreadPool::stealBack(int victim, int& tile) {
+    std::atomic<uint64_t>& range = runs_[victim].range;
+    uint64_t r = range.load(std::memory_order_acquire);
+    for (;;) {
+        uint32_t b = rangeBegin(r), e = rangeEnd(r);
+        if (b >= e) return false;
+        if (range.compare_exchange_weak(r, packRange(b, e - 1), std::memory_order_acq_rel)) {
+            tile = static_cast<int>(e - 1);
+            return true;
+        }
+    }
+}
@@ -0,0 +1,79 @@
+/*
+ * Tiled map storage: cells and per-tile blocking bitplanes for both key states.
+ */
+#include "tile_map.h"
+#include <cstring>
+#include <new>
+
+void TileMap::AlignedFree::operator()(uint8_t* p) const {
+    ::operator delete(p, std::align_val_t(64));
+}
+
+static size_t tileCount(int width, int height) {
+    return static_cast<size_t>((width + TileMap::kTileSize - 1) / TileMap::kTileSize) *
+           ((height + TileMap::kTileSize - 1) / TileMap::kTileSize);
+}
+
+static size_t planeBytes(size_t tiles) {
+    return (tiles * sizeof(uint64_t) + 63) & ~size_t(63);
+}
+
+size_t TileMap::storageBytes(int width, int height) {
+    const size_t tiles = tileCount(width, height);
+    return tiles * kTileCells + 2 * planeBytes(tiles);
+}
+
+TileMap::TileMap(int width, int height) {
+    const size_t bytes = storageBytes(width, height);
+    owned_.reset(static_cast<uint8_t*>(::operator new(bytes, std::align_val_t(64))));
+    std::memset(owned_.get(), 0, bytes);  // Empty cells, nothing blocking
+    bind(owned_.get(), width, height);
+}
+
+TileMap::TileMap(const int* rowMajor, int width, int height) : TileMap(width, height) {
+    for (int y = 0; y < height; ++y)
+        for (int x = 0; x < width; ++x) setCell(x, y, rowMajor[static_cast<size_t>(y) * width + x]);
+}
+
+TileMap TileMap::view(uint8_t* storage, int width, int height) {
+    TileMap m;
+    m.bind(storage, width, height);
+    return m;
+}
+
+void TileMap::bind(uint8_t* storage, int width, int height) {
+    width_ = width;
+    height_ = height;
+    tilesX_ = (width + kTileSize - 1) / kTileSize;
+    const size_t tiles = tileCount(width, height);
+    cells_ = storage;
+    blocking_[0] = reinterpret_cast<uint64_t*>(storage + tiles * kTileCells);
+    blocking_[1] = reinterpret_cast<uint64_t*>(storage + tiles * kTileCells + planeBytes(tiles));
+}
+
+void TileMap::setCell(int x, int y, int cell) {
+    if (x < 0 || x >= width_ || y < 0 || y >= height_) return;
+    const int t = CellGrid::tile(x, y, tilesX_), b = CellGrid::bit(x, y);
+    cells_[static_cast<size_t>(t) * kTileCells + b] = static_cast<uint8_t>(cell);
+    for (int hasKey = 0; hasKey < 2; ++hasKey) {
+        const uint64_t mask = uint64_t(1) << b;
+        if (blocksWith(cell, hasKey != 0)) blocking_[hasKey][t] |= mask;
+        else blocking_[hasKey][t] &= ~mask;
+    }
+}
+
+CellGrid TileMap::grid(bool hasKey) const {
+    CellGrid g;
+    g.cells = cells_;
+    g.blocking = blocking_[hasKey ? 1 : 0];
+    g.tilesX = tilesX_;
+    g.width = width_;
+    g.height = height_;
+    return g;
+}
+
+void TileMap::copyRows(uint8_t* dst) const {
+    const CellGrid g = grid(false);
+    for (int y = 0; y < height_; ++y)
+        for (int x = 0; x < width_; ++x) *dst++ = static_cast<uint8_t>(g.cell(x, y));
+}
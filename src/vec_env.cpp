@@ -0,0 +1,135 @@
+/*
+ * Vectorized headless environment: GameSession rules, DDA ray observations and an
+ * optional low-resolution grey frame for many environments at once. Nothing here
+ * allocates after construction, so step() costs only the ticks and the rays.
+ */
+#include "vec_env.h"
+#include "map.h"
+#include <algorithm>
+#include <thread>
+
+namespace {
+
+// Grey level of each cell type in the frame; only blocking cells (walls, closed doors) stop a ray.
+constexpr uint8_t kCellGrey[] = {0, 200, 130, 255, 255};
+constexpr uint8_t kCeilingGrey = 40;
+constexpr uint8_t kFloorGrey = 80;
+
+} // namespace
+
+VecEnv::VecEnv(const Map& map, const Config& config)
+    : map_(&map), config_(config), caster_(std::clamp(config.rays, 1, kMaxRays), std::max(1, config.frameHeight), 1) {
+    config_.count = std::max(1, config_.count);
+    config_.rays = std::clamp(config_.rays, 1, kMaxRays);
+    config_.frameHeight = std::max(0, config_.frameHeight);
+    config_.ticksPerStep = std::max(1, config_.ticksPerStep);
+    caster_.setMaxDepth(config_.maxDepth);
+
+    int threads = config_.threads > 0 ? config_.threads : static_cast<int>(std::thread::hardware_concurrency());
+    threads = std::min(threads, (config_.count + kEnvTile - 1) / kEnvTile);
+    if (threads > 1) pool_ = std::make_unique<ThreadPool>(threads - 1);
+
+    const size_t n = static_cast<size_t>(config_.count);
+    const size_t rays = n * config_.rays;
+    sessions_.assign(n, GameSession(map));
+    rayDistance_.assign(rays, 0.0f);
+    rayCell_.assign(rays, 0);
+    frames_.assign(rays * config_.frameHeight, 0);
+    pose_.assign(n * 3, 0.0f);
+    hasKey_.assign(n, 0);
+    reward_.assign(n, 0.0f);
+    done_.assign(n, 0);
+    reset();
+}
+
+void VecEnv::reset() {
+    auto resetRange = [this](int begin, int end) {
+        for (int env = begin; env < end; ++env) {
+            sessions_[env].reset();
+            reward_[env] = 0.0f;
+            done_[env] = 0;
+            observe(env);
+        }
+    };
+    if (pool_) pool_->parallelFor(config_.count, kEnvTile, resetRange);
+    else resetRange(0, config_.count);
+}
+
+void VecEnv::step(const uint8_t* actions) {
+    if (pool_) pool_->parallelFor(config_.count, kEnvTile, [&](int begin, int end) { stepRange(actions, begin, end); });
+    else stepRange(actions, 0, config_.count);
+}
+
+void VecEnv::stepRange(const uint8_t* actions, int begin, int end) {
+    const double turn = config_.turnSpeed * config_.tickSeconds;
+    for (int env = begin; env < end; ++env) {
+        GameSession& session = sessions_[env];
+        const uint8_t action = actions[env];
+        SessionInput input;
+        input.buttons = action & (North | South | West | East);  // Restart is not an action
+        float reward = config_.stepReward;
+        bool ended = false;
+        for (int t = 0; t < config_.ticksPerStep && !ended; ++t) {
+            input.angle = session.player().angle;
+            if (action & TurnLeft) input.angle -= turn;
+            if (action & TurnRight) input.angle += turn;
+            const uint8_t events = session.tick(input, config_.tickSeconds);
+            if (events & GameSession::KeyPickedUp) reward += config_.keyReward;
+            if (events & GameSession::Escaped)
+                reward += config_.exitReward + static_cast<float>(session.timeLeft() / GameSession::kTimeLimit);
+            if (events & GameSession::TimedOut) reward += config_.timeoutReward;
+            ended = session.hasWon() || session.hasLost();
+        }
+        if (ended) session.reset();
+        reward_[env] = reward;
+        done_[env] = ended;
+        observe(env);
+    }
+}
+
+void VecEnv::observe(int env) {
+    const GameSession& session = sessions_[env];
+    const Player& player = session.player();
+    pose_[env * 3 + 0] = static_cast<float>(player.x);
+    pose_[env * 3 + 1] = static_cast<float>(player.y);
+    pose_[env * 3 + 2] = static_cast<float>(player.angle);
+    hasKey_[env] = session.hasKey();
+
+    // Same camera and DDA as the game's CPU path, one ray per observation column. The frame
+    // is flat-shaded: grey by cell type, darker with distance and on y faces; no textures
+    // or sprites, which is enough for a convolutional policy.
+    const CellGrid grid = map_->tiles().grid(session.hasKey());
+    const Raycaster::Camera cam = caster_.makeCamera(player);
+    const int rays = config_.rays, height = config_.frameHeight;
+    const size_t base = static_cast<size_t>(env) * rays;
+    int top[kMaxRays], bottom[kMaxRays];
+    uint8_t wall[kMaxRays];
+    for (int x = 0; x < rays; ++x) {
+        const float cameraX = 2.0f * x / static_cast<float>(rays) - 1.0f;
+        const RayHit hit = caster_.castRayDda(cam.originX, cam.originY, cam.dirX + cam.planeX * cameraX,
+                                              cam.dirY + cam.planeY * cameraX, grid);
+        rayDistance_[base + x] = hit.distance;
+        rayCell_[base + x] = static_cast<uint8_t>(hit.cell);
+        if (!height) continue;
+        top[x] = height;  // No wall: ceiling meets floor at the middle
+        bottom[x] = height - 1;
+        wall[x] = 0;
+        if (hit.cell) {
+            const float line = std::min(height / std::max(hit.distance, 1e-4f), 2.0f * height);
+            top[x] = std::max(0, static_cast<int>((height - line) / 2));
+            bottom[x] = std::min(height - 1, static_cast<int>((height + line) / 2));
+            float shade = 1.0f - 0.7f * hit.distance / config_.maxDepth;
+            if (hit.side) shade *= 0.75f;
+            // Cell bytes come from the level file unchecked; unknown blocking ones draw as walls.
+            const int cell = hit.cell <= Cell::Exit ? hit.cell : Cell::Wall;
+            wall[x] = static_cast<uint8_t>(kCellGrey[cell] * shade);
+        }
+    }
+    if (!height) return;
+
+    uint8_t* row = frames_.data() + base * height;
+    for (int y = 0; y < height; ++y, row += rays) {
+        const uint8_t background = y < height / 2 ? kCeilingGrey : kFloorGrey;
+        for (int x = 0; x < rays; ++x) row[x] = (y >= top[x] && y <= bottom[x]) ? wall[x] : background;
+    }
+}
@@ -0,0 +1,162 @@
+/*
+ * Procedural textures and their shading colormaps. Each texture owns 32 palette entries:
+ * a 16-step brightness ramp of its main color and one of its trim color (mortar, iron,
+ * frame, grout), so a texel is just (ramp, brightness). Patterns pick brightness on a
+ * 0..31 scale.
+ */
+#include "wall_textures.h"
+#include "framebuffer.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+constexpr float kFogDistance = 12.0f;          // Same falloff as the GL shader
+constexpr float kFog[3] = {89.0f, 97.0f, 102.0f};
+constexpr int kRampSteps = 16;
+
+struct Rgb { float r, g, b; };
+// [texture][ramp]: main color, trim color.
+constexpr Rgb kColors[6][2] = {
+    {{170, 95, 75}, {125, 118, 108}},   // Wall: brick, mortar
+    {{140, 95, 60}, {105, 105, 115}},   // Door: planks, iron bands
+    {{235, 190, 60}, {150, 110, 30}},   // Key: gold plate, dark gold rim
+    {{60, 185, 95}, {25, 90, 45}},      // Exit: green panel, dark frame
+    {{120, 112, 100}, {60, 56, 52}},    // Floor: flagstones, grout
+    {{95, 110, 130}, {70, 60, 50}},     // Ceiling: plaster, beams
+};
+
+uint32_t hash(uint32_t x, uint32_t y, uint32_t seed) {
+    uint32_t h = x * 0x9E3779B1u ^ y * 0x85EBCA77u ^ seed * 0xC2B2AE3Du;
+    h ^= h >> 15;
+    h *= 0x2C1B3C6Du;
+    h ^= h >> 12;
+    return h;
+}
+
+uint8_t texel(int ramp, int brightness) {
+    return static_cast<uint8_t>(ramp * kRampSteps + std::clamp(brightness, 0, 31) / 2);
+}
+
+// Palette index of a texel from another texture's ramps (for the sprites).
+uint8_t paletteTexel(int texture, int ramp, int brightness) {
+    return static_cast<uint8_t>(texture * 2 * kRampSteps + texel(ramp, brightness));
+}
+
+// Texel (u, v) of each texture: u across the face, v down it.
+uint8_t wallTexel(int u, int v) {
+    const int row = v / 8, offset = (row & 1) * 8;
+    if (v % 8 == 7 || (u + offset) % 16 == 15) return texel(1, 14 + static_cast<int>(hash(u, v, 1) % 4));
+    const int brick = static_cast<int>(hash((u + offset) / 16, row, 2) % 6);
+    return texel(0, 20 + brick + static_cast<int>(hash(u, v, 3) % 4));
+}
+
+uint8_t doorTexel(int u, int v) {
+    if ((v >= 10 && v < 14) || (v >= 50 && v < 54))
+        return texel(1, (u % 16 == 3 ? 28 : 18) + static_cast<int>(hash(u, v, 4) % 3));  // Band with rivets
+    if (u % 8 == 0) return texel(0, 8);                                                     // Gap between planks
+    const int grain = static_cast<int>(hash(u, v / 4, 5) % 5);
+    return texel(0, 19 + grain + static_cast<int>(hash(u / 8, 0, 6) % 4));
+}
+
+uint8_t keyTexel(int u, int v) {
+    const int edge = std::min({u, v, 63 - u, 63 - v});
+    if (edge < 4) return texel(1, edge == 0 ? 12 : 22);
+    if (edge == 4) return texel(0, 31);  // Bevel highlight
+    return texel(0, 22 + static_cast<int>(hash(u, v, 7) % 4));
+}
+
+uint8_t exitTexel(int u, int v) {
+    const int edge = std::min({u, v, 63 - u, 63 - v});
+    if (edge < 6) return texel(1, 16 + static_cast<int>(hash(u, v, 8) % 4));
+    const bool inner = u >= 14 && u < 50 && v >= 12 && v < 58;  // Recessed door leaf
+    if (inner && (u == 14 || u == 49 || v == 12)) return texel(1, 24);
+    return texel(0, (inner ? 26 : 20) + static_cast<int>(hash(u, v, 9) % 3));
+}
+
+uint8_t floorTexel(int u, int v) {
+    const int offset = (v / 32) * 16;  // Stagger alternate rows of 32 x 32 flagstones
+    if (v % 32 == 0 || (u + offset) % 32 == 0) return texel(1, 12 + static_cast<int>(hash(u, v, 10) % 4));
+    const int stone = static_cast<int>(hash((u + offset) / 32, v / 32, 11) % 6);
+    return texel(0, 16 + stone + static_cast<int>(hash(u, v, 12) % 5));
+}
+
+uint8_t ceilingTexel(int u, int v) {
+    if (v % 32 < 6) return texel(1, (v % 32 == 0 ? 10 : 18) + static_cast<int>(hash(u / 2, v, 13) % 4));  // Beam
+    return texel(0, 20 + static_cast<int>(hash(u / 2, v / 2, 14) % 4));
+}
+
+// Sprites return whole palette indices. u runs left to right, v top to bottom; the sprite
+// stands on the bottom row.
+uint8_t keySprite(int u, int v) {
+    constexpr int kKey = Cell::Key - Cell::Wall;
+    const int bx = u - 32, by = v - 20;  // Bow: a ring around (32, 20)
+    const int r2 = bx * bx + by * by;
+    if (r2 <= 12 * 12 && r2 >= 6 * 6) return paletteTexel(kKey, 0, r2 < 9 * 9 ? 30 : 22);
+    if (u >= 29 && u < 35 && v >= 31 && v < 60) return paletteTexel(kKey, 0, u == 29 ? 30 : 24);  // Shaft
+    if (u >= 35 && u < 43 && ((v >= 46 && v < 50) || (v >= 54 && v < 59))) return paletteTexel(kKey, 1, 24);  // Teeth
+    return WallTextures::kTransparent;
+}
+
+uint8_t exitSprite(int u, int v) {
+    constexpr int kExit = Cell::Exit - Cell::Wall;
+    // Arched doorway: a frame around a bright glowing opening.
+    const int cx = u - 32, cy = v - 24;
+    const bool insideOuter = u >= 8 && u < 56 && (v >= 24 || cx * cx + cy * cy < 24 * 24);
+    const bool insideInner = u >= 16 && u < 48 && (v >= 24 || cx * cx + cy * cy < 16 * 16);
+    if (!insideOuter) return WallTextures::kTransparent;
+    if (!insideInner) return paletteTexel(kExit, 1, 18 + static_cast<int>(hash(u, v, 15) % 6));
+    return paletteTexel(kExit, 0, 31 - std::min(std::abs(cx), 15) / 2 - static_cast<int>(hash(u, v, 16) % 3));
+}
+
+} // namespace
+
+WallTextures::WallTextures(float maxDepth)
+    : atlas_(static_cast<size_t>(kTextures) * kSize * kSize + 3),
+      colormaps_(static_cast<size_t>(2) * kShadeLevels * 256, 0xFF000000u),
+      spriteSpans_(static_cast<size_t>(kSpriteTextures) * kSize),
+      levelScale_(kShadeLevels / maxDepth) {
+    uint8_t (*const generators[kFirstSprite])(int, int) = {wallTexel, doorTexel, keyTexel, exitTexel,
+                                                           floorTexel, ceilingTexel};
+    const int scale = 64 / kSize;  // The patterns are drawn on a 64 x 64 grid
+    for (int t = 0; t < kFirstSprite; ++t)
+        for (int u = 0; u < kSize; ++u)
+            for (int v = 0; v < kSize; ++v)
+                atlas_[(static_cast<size_t>(t) * kSize + u) * kSize + v] =
+                    static_cast<uint8_t>(t * 2 * kRampSteps + generators[t](u * scale, v * scale));
+    uint8_t (*const sprites[kSpriteTextures])(int, int) = {keySprite, exitSprite};
+    for (int t = 0; t < kSpriteTextures; ++t)
+        for (int u = 0; u < kSize; ++u) {
+            uint8_t* column = &atlas_[(static_cast<size_t>(kFirstSprite + t) * kSize + u) * kSize];
+            Span span = {kSize, 0};
+            for (int v = 0; v < kSize; ++v) {
+                column[v] = sprites[t](u * scale, v * scale);
+                if (column[v] == kTransparent) continue;
+                span.first = std::min<uint8_t>(span.first, static_cast<uint8_t>(v));
+                span.end = static_cast<uint8_t>(v + 1);
+            }
+            if (span.end == 0) span.first = 0;
+            spriteSpans_[static_cast<size_t>(t) * kSize + u] = span;
+        }
+
+    for (int side = 0; side < 2; ++side)
+        for (int level = 0; level < kShadeLevels; ++level) {
+            const float distance = (level + 0.5f) / levelScale_;
+            float shade = 1.0f - distance / maxDepth * 0.5f;
+            if (side) shade *= 0.8f;
+            const float fog = 1.0f - std::exp(-distance / kFogDistance);
+            uint32_t* map = &colormaps_[(static_cast<size_t>(side) * kShadeLevels + level) * 256];
+            for (int t = 0; t < kFirstSprite; ++t)
+                for (int ramp = 0; ramp < 2; ++ramp)
+                    for (int step = 0; step < kRampSteps; ++step) {
+                        const Rgb& c = kColors[t][ramp];
+                        const float lit = shade * (0.35f + 0.65f * step / (kRampSteps - 1));
+                        auto channel = [&](float base, float fogColor) {
+                            const float v = base * lit + (fogColor - base * lit) * fog;
+                            return static_cast<uint8_t>(std::clamp(v + 0.5f, 0.0f, 255.0f));
+                        };
+                        map[(t * 2 + ramp) * kRampSteps + step] =
+                            Framebuffer::rgb(channel(c.r, kFog[0]), channel(c.g, kFog[1]), channel(c.b, kFog[2]));
+                    }
+        }
+}
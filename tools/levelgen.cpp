@@ -0,0 +1,95 @@
+/*
+ * Level file generator.
+ * ---------------------
+ *   levelgen builtin OUT.lvl                 Export the built-in 24x24 dungeon
+ *   levelgen maze SIZE OUT.lvl [SEED]        SIZE x SIZE grid of 16-cell rooms with pillars,
+ *                                            a key, and the exit behind locked doors
+ *
+ * Output is the version-1 level format from map.h; run it with `raycaster --level OUT.lvl`.
+ */
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include "map.h"
+
+namespace {
+
+struct Rng {
+    unsigned state;
+    unsigned next() { state ^= state << 13; state ^= state >> 17; state ^= state << 5; return state; }
+};
+
+Map makeMaze(int size, unsigned seed) {
+    const int room = 16;
+    TileMap tiles(size, size);
+    Rng rng{seed ? seed : 1u};
+    for (int y = 0; y < size; ++y)
+        for (int x = 0; x < size; ++x) {
+            bool border = x == 0 || y == 0 || x == size - 1 || y == size - 1;
+            bool roomWall = (x % room == 0) || (y % room == 0);
+            bool pillar = (rng.next() % 100) < 3;
+            if (border || roomWall || pillar) tiles.setCell(x, y, Cell::Wall);
+        }
+    // Two-cell doorways in the top and left wall of every room.
+    for (int ry = 0; ry < size; ry += room)
+        for (int rx = 0; rx < size; rx += room) {
+            int dx = rx + 1 + static_cast<int>(rng.next() % (room - 2));
+            int dy = ry + 1 + static_cast<int>(rng.next() % (room - 2));
+            for (int k = 0; k < 2; ++k) {
+                if (ry > 0 && dx + k < size - 1) tiles.setCell(dx + k, ry, Cell::Empty);
+                if (rx > 0 && dy + k < size - 1) tiles.setCell(rx, dy + k, Cell::Empty);
+            }
+        }
+
+    // Exit in the bottom-right room; its doorways become locked doors. Key in the bottom-left room.
+    const int last = ((size - 3) / room) * room;  // Origin of the last room with an interior
+    int doors = 0;
+    for (int i = last + 1; i < std::min(last + room, size - 1); ++i) {
+        if (tiles.cell(i, last) == Cell::Empty) { tiles.setCell(i, last, Cell::Door); ++doors; }
+        if (tiles.cell(last, i) == Cell::Empty) { tiles.setCell(last, i, Cell::Door); ++doors; }
+    }
+    if (!doors) tiles.setCell(last + 1, last, Cell::Door);  // Room drew no doorway of its own
+
+    auto clearAround = [&](int cx, int cy) {
+        for (int y = cy - 1; y <= cy + 1; ++y)
+            for (int x = cx - 1; x <= cx + 1; ++x)
+                if (x > 0 && y > 0 && x < size - 1 && y < size - 1 && x % room && y % room)
+                    tiles.setCell(x, y, Cell::Empty);
+    };
+    const int mid = std::max(1, (std::min(size - 1, last + room) - last) / 2);
+    LevelInfo info;
+    info.exitX = info.exitY = last + mid;
+    info.keyX = mid;
+    info.keyY = last + mid;
+    clearAround(1, 1);  // Spawn
+    clearAround(last + 1, last + 1);  // Behind the forced door
+    clearAround(info.exitX, info.exitY);
+    clearAround(info.keyX, info.keyY);
+    tiles.setCell(info.exitX, info.exitY, Cell::Exit);
+    tiles.setCell(info.keyX, info.keyY, Cell::Key);
+    return Map(std::move(tiles), info);
+}
+
+int usage(const char* argv0) {
+    std::fprintf(stderr, "usage: %s builtin OUT.lvl\n       %s maze SIZE OUT.lvl [SEED]\n", argv0, argv0);
+    return 1;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) return usage(argv[0]);
+    std::string kind = argv[1];
+    if (kind == "builtin" && argc == 3) return Map().save(argv[2]) ? 0 : 1;
+    if (kind == "maze" && (argc == 4 || argc == 5)) {
+        int size = std::atoi(argv[2]);
+        if (size < 19) {
+            std::fprintf(stderr, "maze SIZE must be at least 19\n");
+            return 1;
+        }
+        unsigned seed = argc == 5 ? static_cast<unsigned>(std::strtoul(argv[4], nullptr, 10)) : 0x9E3779B9u;
+        return makeMaze(size, seed).save(argv[3]) ? 0 : 1;
+    }
+    return usage(argv[0]);
+}
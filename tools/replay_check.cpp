@@ -0,0 +1,148 @@
+/*
+ * Replay verifier.
+ * ----------------
+ *   replay_check [--level file.lvl] [--threads N] [--repeat R] [--verbose] FILE.rcr...
+ *   replay_check [--level file.lvl] --bots N PREFIX
+ *
+ * Plays each replay headless (GameSession only, no window or renderer) and checks that it
+ * reproduces the outcome recorded in its header: final position, key, win or loss, score.
+ * Replays are independent and checked in parallel; --repeat plays the list R times for
+ * throughput runs. Exits non-zero if any replay fails.
+ *
+ * --bots writes N replays of a scripted player (follows the flow field to the key and the
+ * exit, with per-bot mouse and button noise), as test input for the verifier and the game's
+ * --replay.
+ */
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+#include "map.h"
+#include "navigation.h"
+#include "replay.h"
+#include "thread_pool.h"
+
+namespace {
+
+constexpr double kMouseSensitivity = 0.003;
+
+struct Rng {
+    unsigned state;
+    unsigned next() { state ^= state << 13; state ^= state >> 17; state ^= state << 5; return state; }
+};
+
+int usage(const char* argv0) {
+    std::fprintf(stderr,
+        "usage: %s [--level file.lvl] [--threads N] [--repeat R] [--verbose] FILE.rcr...\n"
+        "       %s [--level file.lvl] --bots N PREFIX\n",
+        argv0, argv0);
+    return 1;
+}
+
+// One run of a bot that walks the objective's flow field toward the centre of the next cell,
+// glancing around with the mouse and now and then holding a wrong button.
+bool recordBot(const Map& map, const FlowField& toKey, const FlowField& toExit, unsigned seed,
+               const std::string& path) {
+    GameSession session(map);
+    ReplayWriter writer(map, GameSession::kTicksPerSecond, kMouseSensitivity);
+    Rng rng{seed | 1u};
+    uint8_t noise = 0;
+    while (!session.hasWon() && !session.hasLost()) {
+        const Player& p = session.player();
+        const FlowField& field = session.hasKey() ? toExit : toKey;
+        const FlowField::Step step = field.next(static_cast<int>(p.x), static_cast<int>(p.y));
+        const double targetX = static_cast<int>(p.x) + 0.5 + step.dx, targetY = static_cast<int>(p.y) + 0.5 + step.dy;
+        TickInput input;
+        if (targetX > p.x + 0.05) input.buttons |= Button::East;
+        if (targetX < p.x - 0.05) input.buttons |= Button::West;
+        if (targetY > p.y + 0.05) input.buttons |= Button::South;
+        if (targetY < p.y - 0.05) input.buttons |= Button::North;
+        if (rng.next() % 240 == 0) noise = static_cast<uint8_t>(rng.next() & 15);
+        if (rng.next() % 60 == 0) noise = 0;
+        input.buttons ^= noise;
+        if (rng.next() % 2 == 0) input.mouseDx = static_cast<int32_t>(rng.next() % 41) - 20;
+        writer.record(input);
+        session.tick(input.toSession(session, kMouseSensitivity), 1.0 / GameSession::kTicksPerSecond);
+    }
+    return writer.save(path, session);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    const char* levelPath = nullptr;
+    int threads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    int repeat = 1;
+    int bots = 0;
+    bool verbose = false;
+    std::vector<std::string> files;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc && argv[i + 1][0] != '-';
+        if (arg == "--level" && hasValue) levelPath = argv[++i];
+        else if (arg == "--threads" && hasValue) threads = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--repeat" && hasValue) repeat = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--bots" && hasValue) bots = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--verbose") verbose = true;
+        else if (arg == "--help") return usage(argv[0]) - 1;
+        else if (arg[0] == '-') return usage(argv[0]);
+        else files.push_back(arg);
+    }
+    if (files.empty() || (bots && files.size() != 1)) return usage(argv[0]);
+
+    Map map;
+    if (levelPath && !map.load(levelPath)) return 1;
+
+    if (bots) {
+        Navigation navigation;
+        navigation.build(map, true);  // toExit() through the open doors; toKey() never uses them
+        for (int i = 0; i < bots; ++i) {
+            const std::string path = files[0] + "-" + std::to_string(i) + ".rcr";
+            if (!recordBot(map, navigation.toKey(), navigation.toExit(), 0x9E3779B9u * (i + 1), path)) return 1;
+        }
+        std::printf("Wrote %d replays to %s-*.rcr\n", bots, files[0].c_str());
+        return 0;
+    }
+
+    // A file that does not load is a failed replay, not the end of the run.
+    std::vector<Replay> replays(files.size());
+    std::vector<uint8_t> loaded(files.size());
+    for (size_t i = 0; i < files.size(); ++i) loaded[i] = replays[i].load(files[i]);
+    const uint64_t levelHash = levelFingerprint(map);
+
+    const int count = static_cast<int>(replays.size());
+    std::vector<std::string> why(replays.size(), "unreadable");
+    std::vector<uint8_t> passed(replays.size());
+    std::atomic<long long> ticks{0};
+    ThreadPool pool(threads - 1);
+    const auto t0 = std::chrono::steady_clock::now();
+    for (int r = 0; r < repeat; ++r)
+        pool.parallelFor(count, 1, [&](int begin, int end) {
+            long long played = 0;
+            for (int i = begin; i < end; ++i) {
+                if (!loaded[i]) continue;
+                uint32_t ticksPlayed = 0;
+                passed[i] = replays[i].verify(map, levelHash, &why[i], &ticksPlayed);
+                played += ticksPlayed;  // Only what was simulated; rejected runs add nothing
+            }
+            ticks.fetch_add(played, std::memory_order_relaxed);
+        });
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    int failed = 0;
+    for (int i = 0; i < count; ++i) {
+        const ReplayHeader& h = replays[i].header();
+        if (!passed[i]) ++failed;
+        if (verbose || !passed[i])
+            std::printf("%s: %s, %u ticks, score %d%s%s\n", files[i].c_str(), passed[i] ? "ok" : why[i].c_str(),
+                        h.tickCount, h.score, h.hasWon ? ", escaped" : "", h.hasLost ? ", timed out" : "");
+    }
+    const double runs = static_cast<double>(count) * repeat;
+    std::printf("%d replays, %d failed; %.0f replays/s, %.1f M ticks/s on %d threads\n", count, failed,
+                runs / seconds, ticks.load() / seconds / 1e6, pool.concurrency());
+    return failed ? 1 : 0;
+}